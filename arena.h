@@ -0,0 +1,50 @@
+#ifndef SWEEP_ARENA_H
+#define SWEEP_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "common.h"
+
+//Bump allocation out of one block. Nothing is freed on its own, resetting or destroying the arena frees
+//everything in it at once, so code that makes the same allocations again after a reset never calls malloc.
+
+//every allocation starts on its own cache line.
+#define ARENA_ALIGN 64
+
+typedef struct{
+        void * memory;
+        uint8_t * base;
+        size_t size, used;
+} Arena;
+
+//what size bytes take up in an arena, for sizing one up front.
+static inline size_t arena_bytes(size_t size){
+        return (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+}
+
+static inline void arena_create(Arena * arena, size_t size){
+        *arena = (Arena){0};
+        arena->memory = malloc(size + ARENA_ALIGN);
+        if(!arena->memory) crash("out of memory for an arena");
+        arena->base = (uint8_t *)arena->memory + (ARENA_ALIGN - (uintptr_t)arena->memory % ARENA_ALIGN) % ARENA_ALIGN;
+        arena->size = size;
+}
+
+static inline void arena_destroy(Arena * arena){
+        free(arena->memory);
+        *arena = (Arena){0};
+}
+
+static inline void * arena_push(Arena * arena, size_t size){
+        size = arena_bytes(size);
+        if(size > arena->size - arena->used) crash("out of arena memory");
+        void * memory = arena->base + arena->used;
+        arena->used += size;
+        return memory;
+}
+
+static inline void arena_reset(Arena * arena){
+        arena->used = 0;
+}
+
+#endif
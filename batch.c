@@ -0,0 +1,168 @@
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "arena.h"
+#include "board.h"
+#include "bot.h"
+#include "profile.h"
+#include "thread.h"
+
+//sweep_batch, plays lots of games headless with a bot and prints how they went. every game gets its own seed
+//from the batch seed and its index, so the totals are the same however the games land on threads.
+
+typedef struct{
+        int64_t games;
+        int64_t wins;
+        int64_t revealed;
+        int64_t safe_tiles;
+        int64_t moves;
+        int64_t guesses;
+        int64_t guesses_survived;
+} Batch_Totals;
+
+//everything a thread touches while playing, made on first use by the thread itself. threads share nothing
+//until the totals get added up at the end.
+typedef struct{
+        int ready;
+        Arena arena;
+        Board board;
+        void * bot;
+        Batch_Totals totals;
+        //keeps the next thread's totals off this cache line.
+        char padding[64];
+} Batch_Thread;
+
+typedef struct{
+        Bot const * bot;
+        int grid_width, grid_height;
+        double mine_density;
+        uint64_t seed;
+        int no_guess;
+        Batch_Thread * threads;
+} Batch;
+
+static void play_game(void * batch_p, int thread_index, int64_t game){
+        Batch * batch = batch_p;
+        Batch_Thread * thread = &batch->threads[thread_index];
+        Board * board = &thread->board;
+        if(!thread->ready){
+                int tile_count = batch->grid_width * batch->grid_height;
+                board_create(board, batch->grid_width, batch->grid_height, tile_count * batch->mine_density, 0);
+                //the games are the parallelism, each one plants on its own thread.
+                board->plant_threads = 1;
+                board->no_guess = batch->no_guess;
+                arena_create(&thread->arena, batch->bot->memory(batch->grid_width, batch->grid_height));
+                thread->bot = batch->bot->create(&thread->arena, batch->grid_width, batch->grid_height);
+                thread->ready = 1;
+        }
+
+        uint64_t game_seed = batch->seed ^ ((uint64_t)game * 0xd1b54a32d192ed03);
+        board->seed = splitmix64(&game_seed);
+        rng_seed(&board->rng, board->seed);
+        Rng rng;
+        rng_seed(&rng, ~board->seed);
+        //the last game may have ended on a mine, the game would animate that and replant.
+        board->failing = not_exploding;
+        board_clear(board);
+        board_reveal(board, board->grid_width / 2, board->grid_height / 2);
+        board_fill(board, INT_MAX);
+        batch->bot->start(thread->bot, board);
+
+        Batch_Totals * totals = &thread->totals;
+        int safe_tiles = board->grid_width * board->grid_height - board->unflagged_mines;
+        //every move opens or flags a tile, so a bot taking more than that is stuck.
+        int64_t moves_left = (int64_t)board->grid_width * board->grid_height;
+        int lost = 0;
+        while(board->hidden_safe_tiles > 0 && !lost){
+                if(moves_left-- == 0) crash("the bot stopped making progress");
+                Move move = batch->bot->move(thread->bot, board, &rng);
+                int x = move.tile % board->grid_width;
+                int y = move.tile / board->grid_width;
+                ++totals->moves;
+                if(move.kind == move_flag){
+                        board_flag(board, x, y);
+                        continue;
+                }
+                lost = board_reveal(board, x, y) == reveal_exploded;
+                board_fill(board, INT_MAX);
+                totals->guesses += move.guess;
+                totals->guesses_survived += move.guess && !lost;
+        }
+        ++totals->games;
+        totals->wins += !lost;
+        totals->revealed += safe_tiles - board->hidden_safe_tiles;
+        totals->safe_tiles += safe_tiles;
+}
+
+static c_str usage = "usage: sweep_batch [--no-guess] [bot] [games] [width] [height] [mine density] [seed] [threads]\n";
+
+int main(int argc, char ** argv){
+        Batch batch = {
+                .bot = bot_named("solver"),
+                .grid_width = 30,
+                .grid_height = 16,
+                .mine_density = .2,
+                .seed = 42069,
+        };
+        int64_t games = 100000;
+        int thread_count = hardware_threads();
+
+        if(argc > 1 && !strcmp(argv[1], "--no-guess")){
+                batch.no_guess = 1;
+                --argc;
+                ++argv;
+        }
+        errno = 0;
+        char * end = "";
+        if(argc > 1) batch.bot = bot_named(argv[1]);
+        if(argc > 2) games = strtoll(argv[2], &end, 10);
+        if(argc > 3 && !*end) batch.grid_width = strtol(argv[3], &end, 10);
+        if(argc > 4 && !*end) batch.grid_height = strtol(argv[4], &end, 10);
+        if(argc > 5 && !*end) batch.mine_density = strtod(argv[5], &end);
+        if(argc > 6 && !*end) batch.seed = strtoull(argv[6], &end, 10);
+        if(argc > 7 && !*end) thread_count = strtol(argv[7], &end, 10);
+        if(!batch.bot){
+                fputs("bots:", stderr);
+                for(int i = 0; i < bot_count; ++i) fprintf(stderr, " %s", bots[i].name);
+                fputs("\n", stderr);
+                crash(usage);
+        }
+        if(argc > 8 || *end || errno || games < 1 || batch.grid_width < 1 || batch.grid_height < 1 || thread_count < 1
+                        || !(batch.mine_density >= 0 && batch.mine_density < 1)) crash(usage);
+
+        batch.threads = calloc(thread_count, sizeof(Batch_Thread));
+        if(!batch.threads) crash("out of memory for the batch");
+        double start = profile_now();
+        //small batches so a thread that drew slow games hands the rest of its share to ones that didn't.
+        parallel_for_stealing(games, thread_count, 64, play_game, &batch);
+        double seconds = profile_now() - start;
+
+        Batch_Totals totals = {0};
+        int threads_used = 0;
+        for(int i = 0; i < thread_count; ++i){
+                Batch_Thread * thread = &batch.threads[i];
+                if(!thread->ready) continue;
+                ++threads_used;
+                totals.games += thread->totals.games;
+                totals.wins += thread->totals.wins;
+                totals.revealed += thread->totals.revealed;
+                totals.safe_tiles += thread->totals.safe_tiles;
+                totals.moves += thread->totals.moves;
+                totals.guesses += thread->totals.guesses;
+                totals.guesses_survived += thread->totals.guesses_survived;
+                board_destroy(&thread->board);
+                arena_destroy(&thread->arena);
+        }
+        free(batch.threads);
+
+        printf("%s on %dx%d with %.1f%% mines%s, %lld games on %d threads in %.3fs, %.1f games/s\n",
+                        batch.bot->name, batch.grid_width, batch.grid_height, batch.mine_density * 100, batch.no_guess ? ", no guess boards" : "",
+                        (long long)totals.games, threads_used, seconds, totals.games / seconds);
+        printf("won %.2f%%, revealed %.2f%% of safe tiles, %.2f moves and %.3f guesses a game, %.2f%% of guesses survived\n",
+                        100.0 * totals.wins / totals.games, 100.0 * totals.revealed / totals.safe_tiles,
+                        (double)totals.moves / totals.games, (double)totals.guesses / totals.games,
+                        totals.guesses ? 100.0 * totals.guesses_survived / totals.guesses : 100.0);
+}
@@ -0,0 +1,617 @@
+#define _POSIX_C_SOURCE 199309L
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "common.h"
+#include "board.h"
+#include "bitboard.h"
+#include "chunk.h"
+#include "game.h"
+#include "generate.h"
+#include "snapshot.h"
+#include "solver.h"
+
+//sweep_bench, times the simulation without a window.
+
+static uint64_t now_ns(void){
+        struct timespec time;
+        clock_gettime(CLOCK_MONOTONIC, &time);
+        return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+typedef struct{
+        int width, height;
+} Board_Size;
+
+Board_Size sizes[] = {
+        {11, 12},
+        {64, 64},
+        {256, 256},
+        {1000, 1000},
+        {1024, 1024},
+        {4096, 4096},
+};
+
+static void report(c_str name, Board_Size size, uint64_t ns, uint64_t tiles){
+        printf("%-22s %5dx%-5d %12.3f ms %10.3f ns/tile\n", name, size.width, size.height, ns / 1e6, tiles ? (double)ns / tiles : 0.0);
+}
+
+//clicks every safe hidden tile and runs each flood fill to completion,
+//either in one call or a ring per step the way the game animates it.
+static uint64_t reveal_everything(Board * board, int instant, uint64_t * steps){
+        uint64_t revealed = 0;
+        *steps = 0;
+        int tile_count = board->grid_width * board->grid_height;
+        for(int i = 0; i < tile_count; ++i){
+                if(board->tiles[i] != hidden) continue;
+                board_reveal(board, i % board->grid_width, i / board->grid_width);
+                if(instant){
+                        board_fill(board, INT_MAX);
+                        ++*steps;
+                }else for(; board->filling; ++*steps) board_step(board);
+        }
+        for(int i = 0; i < tile_count; ++i) revealed += !test_flags(board->tiles[i], hidden);
+        return revealed;
+}
+
+//the chunked board has to agree with the dense one given the same mines. it keeps almost nothing resident,
+//so the fill keeps evicting and remaking chunks under itself.
+static void check_chunks(Board_Size size){
+        Chunk_Board chunks;
+        chunk_board_create(&chunks, size.width, size.height, .2, 42069, 4);
+        int click_x = size.width / 2, click_y = size.height / 2;
+        if(chunk_board_reveal(&chunks, click_x, click_y) != reveal_filling) crash("the first chunked reveal wasn't safe");
+
+        Board board;
+        board_create(&board, size.width, size.height, 0, 42069);
+        int mines = 0;
+        for(int y = 0; y < size.height; ++y){
+                for(int x = 0; x < size.width; ++x){
+                        if(!test_flags(chunk_board_tile(&chunks, x, y), charged)) continue;
+                        board.tiles[board_tile_index(&board, x, y)] |= charged;
+                        ++mines;
+                }
+        }
+        board.total_mines = mines;
+        board.hidden_safe_tiles = size.width * size.height - mines;
+        board.unflagged_mines = mines;
+        board.planted = 1;
+        board_count_mines(&board);
+        board_verify(&board);
+        board_reveal(&board, click_x, click_y);
+        board_fill(&board, INT_MAX);
+
+        while(chunks.filling) chunk_board_fill(&chunks, 1 << 8);
+        for(int y = 0; y < size.height; ++y){
+                for(int x = 0; x < size.width; ++x){
+                        Tile tile = board_tile(&board, x, y);
+                        if(chunk_board_tile(&chunks, x, y) != tile) crash("chunked board tiles don't match the dense board");
+                        if(!test_flags(tile, hidden) && chunk_board_mine_count(&chunks, x, y) != board_mine_count(&board, x, y)) crash("chunked board mine counts don't match");
+                }
+        }
+        if(chunks.evicted_chunks == 0) crash("the chunked board never evicted anything");
+        board_destroy(&board);
+        chunk_board_destroy(&chunks);
+}
+
+//clicks all over a board far too big to ever hold densely and keeps only what got explored.
+static void bench_chunks(void){
+        Board_Size checks[] = {{256, 256}, {1000, 701}};
+        for(uint64_t i = 0; i < ARRAY_SIZE(checks); ++i) check_chunks(checks[i]);
+
+        int64_t side = (int64_t)1 << 40;
+        Chunk_Board board;
+        chunk_board_create(&board, side, side, .2, 42069, 64);
+        Rng rng;
+        rng_seed(&rng, 7);
+        int clicks = 1000;
+        uint64_t start = now_ns();
+        for(int click = 0; click < clicks; ++click){
+                chunk_board_reveal(&board, rng_next(&rng) & (side - 1), rng_next(&rng) & (side - 1));
+                chunk_board_fill(&board, UINT64_MAX);
+        }
+        uint64_t ns = now_ns() - start;
+        printf("%-22s %11s %12.3f ms %10.3f ns/tile\n", "chunked reveal", "2^40x2^40", ns / 1e6, (double)ns / board.revealed_tiles);
+        printf("%-22s %18llu tiles revealed in %d clicks\n", "", (unsigned long long)board.revealed_tiles, clicks);
+        printf("%-22s %18llu chunks made, %llu evicted, %llu resident %.1f MB\n", "",
+                        (unsigned long long)board.generated_chunks, (unsigned long long)board.evicted_chunks,
+                        (unsigned long long)board.chunk_count, chunk_board_resident_bytes(&board) / 1e6);
+        chunk_board_evict(&board, 0);
+        printf("%-22s %18llu chunks explored %.1f MB\n", "", (unsigned long long)board.chunk_count, chunk_board_resident_bytes(&board) / 1e6);
+        chunk_board_destroy(&board);
+}
+
+static void check_same_board(Board const * board, Board const * loaded){
+        uint64_t tile_count = (uint64_t)board->grid_width * board->grid_height;
+        if(board->grid_width != loaded->grid_width || board->grid_height != loaded->grid_height
+                        || board->total_mines != loaded->total_mines || board->seed != loaded->seed
+                        || memcmp(board->rng.s, loaded->rng.s, sizeof(board->rng.s))
+                        || board->planted != loaded->planted || board->first_click_safe != loaded->first_click_safe
+                        || board->hidden_safe_tiles != loaded->hidden_safe_tiles || board->unflagged_mines != loaded->unflagged_mines
+                        || board->flagged_mines != loaded->flagged_mines || board->wrong_flags != loaded->wrong_flags
+                        || board->failing != loaded->failing || board->exploding_mine_index != loaded->exploding_mine_index
+                        || board->clearing_row_index != loaded->clearing_row_index || board->filling != loaded->filling) crash("the snapshot lost some of the board's state");
+        if(memcmp(board->tiles, loaded->tiles, sizeof(Tile) * tile_count)) crash("the snapshot lost tiles");
+        if(memcmp(board->mine_counts, loaded->mine_counts, tile_count)) crash("the snapshot lost mine counts");
+        if(board->filling && (board_fill_frontier(board) != board_fill_frontier(loaded)
+                        || memcmp(board->tiles_to_search + board->fill_head, loaded->tiles_to_search + loaded->fill_head, sizeof(int) * board_fill_frontier(board)))) crash("the snapshot lost the flood fill");
+        board_verify(loaded);
+}
+
+//overwrites bytes of a saved snapshot, for handing snapshot_load files that were edited.
+static void edit_file(c_str path, uint64_t offset, void const * data, size_t size){
+        FILE * file = fopen(path, "r+b");
+        if(!file || fseek(file, offset, SEEK_SET) || fwrite(data, 1, size, file) != size || fclose(file)) crash("couldn't edit the snapshot");
+}
+
+//a header whose counters are off has them recounted, a tile with bits no board makes doesn't load.
+static void check_edited_snapshots(Board const * board, c_str path){
+        if(!snapshot_save(board, path)) crash("couldn't save a snapshot");
+        Snapshot_Header header;
+        FILE * file = fopen(path, "rb");
+        if(!file || fread(&header, sizeof(header), 1, file) != 1 || fclose(file)) crash("couldn't read the snapshot header");
+
+        Snapshot_Header edited = header;
+        edited.hidden_safe_tiles += 5;
+        edited.unflagged_mines = 0;
+        edit_file(path, 0, &edited, sizeof(edited));
+        Board loaded;
+        if(!snapshot_load(&loaded, path)) crash("couldn't load a snapshot with edited counters");
+        check_same_board(board, &loaded);
+        board_destroy(&loaded);
+
+        Tile tile = board->tiles[0] | 1 << 6;
+        edit_file(path, header.tiles_offset, &tile, sizeof(tile));
+        if(snapshot_load(&loaded, path)) crash("loaded a snapshot with a tile no board makes");
+}
+
+//saves a board part way through a fill, loads it and plays both on, then does the same through an incremental save.
+//then times loading a board of 10^8 tiles.
+static void bench_snapshots(void){
+        c_str path = "sweep_bench.snapshot";
+        Board board;
+        board_create(&board, 1000, 701, 1000 * 701 * 0.1, 42069);
+        board_reveal(&board, 500, 350);
+        board_fill(&board, 1000);
+        board_flag(&board, 3, 4);
+        if(!board.filling) crash("the fill finished before it could be saved");
+        if(!snapshot_save(&board, path)) crash("couldn't save a snapshot");
+        uint64_t saved_changes = board.changes;
+
+        Board loaded;
+        if(!snapshot_load(&loaded, path)) crash("couldn't load a snapshot");
+        check_same_board(&board, &loaded);
+        board_fill(&board, INT_MAX);
+        board_fill(&loaded, INT_MAX);
+        board_flag(&board, 999, 700);
+        board_flag(&loaded, 999, 700);
+        check_same_board(&board, &loaded);
+        board_destroy(&loaded);
+
+        //only the rows touched since the first save go out, the file has to end up the same as a full save.
+        board_reveal(&board, 10, 10);
+        board_fill(&board, 10);
+        if(!snapshot_save_changes(&board, path, saved_changes)) crash("couldn't save snapshot changes");
+        if(!snapshot_load(&loaded, path)) crash("couldn't load a snapshot");
+        check_same_board(&board, &loaded);
+        board_destroy(&loaded);
+        check_edited_snapshots(&board, path);
+
+        //a replant takes mines out band by band, which moves the counts on the row above a band after that row
+        //was cleared. an incremental save part way through has to carry those counts.
+        board_fill(&board, INT_MAX);
+        int mine = 0;
+        while(!test_flags(board.tiles[mine], charged) || test_flags(board.tiles[mine], flagged)) ++mine;
+        board_reveal(&board, mine % board.grid_width, mine / board.grid_width);
+        while(board.failing == exploding) board_step(&board);
+        board_step(&board);
+        if(!snapshot_save(&board, path)) crash("couldn't save a snapshot");
+        saved_changes = board.changes;
+        board_step(&board);
+        if(board.failing != re_planting) crash("the replant finished before it could be saved");
+        if(!snapshot_save_changes(&board, path, saved_changes)) crash("couldn't save snapshot changes");
+        if(!snapshot_load(&loaded, path)) crash("couldn't load a snapshot");
+        check_same_board(&board, &loaded);
+        board_destroy(&loaded);
+        board_destroy(&board);
+
+        Board_Size size = {10000, 10000};
+        uint64_t tile_count = (uint64_t)size.width * size.height;
+        board_create(&board, size.width, size.height, tile_count * 0.2, 42069);
+        board_reveal(&board, size.width / 2, size.height / 2);
+        board_fill(&board, INT_MAX);
+        uint64_t start = now_ns();
+        if(!snapshot_save(&board, path)) crash("couldn't save a snapshot");
+        report("snapshot save", size, now_ns() - start, tile_count);
+        saved_changes = board.changes;
+
+        start = now_ns();
+        if(!snapshot_load(&loaded, path)) crash("couldn't load a snapshot");
+        report("snapshot load", size, now_ns() - start, tile_count);
+        start = now_ns();
+        int won = board_check_won(&loaded);
+        report("first scan of load", size, now_ns() - start, tile_count);
+        if(won) crash("won a board with no flags");
+        check_same_board(&board, &loaded);
+        board_destroy(&loaded);
+
+        for(int i = 0; i < 100; ++i) board_flag(&board, i * 97 % size.width, i * 89 % size.height);
+        start = now_ns();
+        if(!snapshot_save_changes(&board, path, saved_changes)) crash("couldn't save snapshot changes");
+        report("snapshot save changes", size, now_ns() - start, tile_count);
+        if(!snapshot_load(&loaded, path)) crash("couldn't load a snapshot");
+        check_same_board(&board, &loaded);
+        board_destroy(&loaded);
+        board_destroy(&board);
+        remove(path);
+}
+
+//the solver on random boards, then no guess boards: small ones for boards per second, a 1000x1000 one against NO_GUESS_SECONDS.
+static void bench_solver(void){
+        Board_Size solve_sizes[] = {{30, 16}, {1000, 1000}};
+        for(uint64_t i = 0; i < ARRAY_SIZE(solve_sizes); ++i){
+                Board_Size size = solve_sizes[i];
+                int tile_count = size.width * size.height;
+                Board board;
+                board_create(&board, size.width, size.height, tile_count * 0.2, 42069);
+                Solver solver;
+                solver_create(&solver, size.width, size.height);
+                int runs = 1 + (1 << 20) / tile_count;
+                int solved = 0;
+                uint64_t frontier = 0;
+                uint64_t ns = 0;
+                for(int run = 0; run < runs; ++run){
+                        board_clear(&board);
+                        board_plant_around(&board, size.width / 2, size.height / 2);
+                        uint64_t start = now_ns();
+                        solved += solver_solve(&solver, &board, size.width / 2, size.height / 2, NULL);
+                        ns += now_ns() - start;
+                        frontier += solver_frontier_cells(&solver);
+                }
+                report("solve random", size, ns / runs, tile_count);
+                printf("%-22s %5dx%-5d %12.3f ns/frontier tile, %d of %d solved without guessing\n", "", size.width, size.height,
+                                frontier ? (double)ns / frontier : 0.0, solved, runs);
+                solver_destroy(&solver);
+                board_destroy(&board);
+        }
+
+        Board_Size size = {30, 16};
+        Board board;
+        board_create(&board, size.width, size.height, size.width * size.height * 0.2, 42069);
+        Solver solver;
+        solver_create(&solver, size.width, size.height);
+        int boards = 0;
+        int attempts = 0;
+        uint64_t start = now_ns();
+        uint64_t ns;
+        while((ns = now_ns() - start) < 1000000000){
+                Generate_Stats stats;
+                if(!generate_no_guess(&board, size.width / 2, size.height / 2, board.plant_threads, 1, &stats)) crash("couldn't generate a no guess board");
+                if(!solver_solve(&solver, &board, size.width / 2, size.height / 2, NULL)) crash("a no guess board needed a guess");
+                ++boards;
+                attempts += stats.attempts;
+        }
+        printf("%-22s %5dx%-5d %12.1f boards/s, %.2f attempts each\n", "no guess", size.width, size.height, boards * 1e9 / ns, (double)attempts / boards);
+
+        //the same seed has to give the same board on any number of threads.
+        Tile * single_threaded = malloc(sizeof(Tile) * size.width * size.height);
+        rng_seed(&board.rng, board.seed);
+        generate_no_guess(&board, 3, 3, 1, 10, NULL);
+        memcpy(single_threaded, board.tiles, sizeof(Tile) * size.width * size.height);
+        rng_seed(&board.rng, board.seed);
+        generate_no_guess(&board, 3, 3, 3, 10, NULL);
+        if(memcmp(single_threaded, board.tiles, sizeof(Tile) * size.width * size.height)) crash("no guess boards depend on the thread count");
+        free(single_threaded);
+        solver_destroy(&solver);
+        board_destroy(&board);
+
+        size = (Board_Size){1000, 1000};
+        board_create(&board, size.width, size.height, size.width * size.height * 0.2, 42069);
+        solver_create(&solver, size.width, size.height);
+        Generate_Stats stats;
+        start = now_ns();
+        int generated = generate_no_guess(&board, size.width / 2, size.height / 2, board.plant_threads, NO_GUESS_SECONDS, &stats);
+        report("no guess", size, now_ns() - start, size.width * size.height);
+        if(generated){
+                printf("%-22s %5dx%-5d %12d attempts, %d passes, %llu repairs\n", "", size.width, size.height,
+                                stats.attempts, stats.passes, (unsigned long long)stats.perturbations);
+                if(!solver_solve(&solver, &board, size.width / 2, size.height / 2, NULL)) crash("a no guess board needed a guess");
+        }else{
+                printf("%-22s %5dx%-5d %12d attempts, missed the %.1fs budget\n", "", size.width, size.height, stats.attempts, NO_GUESS_SECONDS);
+        }
+        solver_destroy(&solver);
+        board_destroy(&board);
+}
+
+//whole rounds on one board: resize within its block, first click, fill, set off a mine, explode and replant, restart.
+//none of it may reach the allocator. the count is only checked when built with -DSWEEP_COUNT_ALLOCATIONS, and on one
+//planting thread since the counter isn't atomic.
+static void bench_rounds(void){
+        Board_Size round_sizes[] = {{1000, 1000}, {640, 480}, {30, 16}};
+        int size_count = ARRAY_SIZE(round_sizes);
+        double densities[] = {.2, .1, .3};
+        Board board;
+        board_create(&board, 1000, 1000, 1000 * 1000 * .2, 42069);
+        board.plant_threads = 1;
+#if defined(SWEEP_COUNT_ALLOCATIONS)
+        uint64_t allocations = allocation_count;
+#endif
+        int rounds = 30;
+        uint64_t tiles = 0;
+        uint64_t start = now_ns();
+        for(int round = 0; round < rounds; ++round){
+                Board_Size size = round_sizes[round % size_count];
+                board_resize(&board, size.width, size.height, size.width * size.height * densities[round % ARRAY_SIZE(densities)]);
+                board_reveal(&board, size.width / 2, size.height / 2);
+                board_fill(&board, INT_MAX);
+                int mine = 0;
+                while(!test_flags(board.tiles[mine], charged)) ++mine;
+                if(board_reveal(&board, mine % size.width, mine / size.width) != reveal_exploded) crash("a mine didn't go off");
+                while(board.failing != not_exploding) board_step(&board);
+                board_restart(&board);
+                while(board.failing != not_exploding) board_step(&board);
+                board_verify(&board);
+                tiles += (uint64_t)size.width * size.height;
+        }
+        uint64_t ns = now_ns() - start;
+#if defined(SWEEP_COUNT_ALLOCATIONS)
+        if(allocation_count != allocations) crash("a round reached the allocator");
+        puts("no allocations in any round");
+#endif
+        printf("%d rounds over %d sizes %12.3f ms a round %10.3f ns/tile\n", rounds, size_count, ns / 1e6 / rounds, (double)ns / tiles);
+        board_destroy(&board);
+}
+
+//a tile's center the way main.c's calculate_hexagon_offset places it.
+static void hexagon_center(float hexagon_diameter, int x, int y, double * center_x, double * center_y){
+        double hex_width = hexagon_diameter * 0.866025404;
+        *center_x = x * hex_width + (y & 1) * hex_width/2 + hex_width/2;
+        *center_y = y * hexagon_diameter * .75 + hexagon_diameter/2;
+}
+
+//picking against a scan for the nearest tile center, at random cursors on random windows, boards and zooms.
+//the scan runs two tiles past every side, the cursor is off the board when the nearest center is out there.
+static void check_picking(void){
+        Rng rng;
+        rng_seed(&rng, 42069);
+        int64_t checked = 0;
+        int64_t on_board = 0;
+        for(int round = 0; round < 200; ++round){
+                int grid_width = 1 + rng_below(&rng, 64);
+                int grid_height = 1 + rng_below(&rng, 64);
+                Game game;
+                game_create(&game, grid_width, grid_height, 0, 0, 64 + rng_below(&rng, 2000), 64 + rng_below(&rng, 2000));
+                //from the whole board in view to a few tiles of it, panned up to a screen either way.
+                float zoom = 1 + rng_below(&rng, 1000) / 100.0;
+                game.camera.zoom *= zoom;
+                game.camera.offset.x = game.camera.offset.x * zoom + ((int)rng_below(&rng, 2001) - 1000) / 1000.0;
+                game.camera.offset.y = game.camera.offset.y * zoom + ((int)rng_below(&rng, 2001) - 1000) / 1000.0;
+                float radius = game.hexagon_diameter * 0.5;
+                for(int click = 0; click < 200; ++click){
+                        double cursor_x = rng_below(&rng, game.screen_width * 16) / 16.0;
+                        double cursor_y = rng_below(&rng, game.screen_height * 16) / 16.0;
+                        Vec2 cursor = screen_to_board(game.camera, game.screen_width, game.screen_height, cursor_x, cursor_y);
+                        int nearest_x = 0, nearest_y = 0;
+                        double nearest = INFINITY, second = INFINITY;
+                        for(int y = -2; y < grid_height + 2; ++y){
+                                for(int x = -2; x < grid_width + 2; ++x){
+                                        double center_x, center_y;
+                                        hexagon_center(game.hexagon_diameter, x, y, &center_x, &center_y);
+                                        double distance = hypot(cursor.x - center_x, cursor.y - center_y);
+                                        if(distance < nearest){
+                                                second = nearest;
+                                                nearest = distance;
+                                                nearest_x = x;
+                                                nearest_y = y;
+                                        }else if(distance < second) second = distance;
+                                }
+                        }
+                        //too close to an edge to say which side it's on.
+                        if(second - nearest < radius * 1e-4) continue;
+                        int expect = nearest_x >= 0 && nearest_x < grid_width && nearest_y >= 0 && nearest_y < grid_height;
+                        int tile_x = -1, tile_y = -1;
+                        int picked = pick_hexagon(game.hexagon_diameter, grid_width, grid_height, cursor.x, cursor.y, &tile_x, &tile_y);
+                        if(picked != expect || (picked && (tile_x != nearest_x || tile_y != nearest_y))){
+                                fprintf(stderr, "%dx%d board, cursor %.4f %.4f picked %d at %d,%d, nearest center is %d,%d\n",
+                                                grid_width, grid_height, cursor_x, cursor_y, picked, tile_x, tile_y, nearest_x, nearest_y);
+                                crash("picking disagrees with the nearest tile center");
+                        }
+                        ++checked;
+                        on_board += expect;
+                }
+                game_destroy(&game);
+        }
+        printf("picking matched the nearest center at %lld cursors, %lld on the board\n", (long long)checked, (long long)on_board);
+}
+
+//clicks while a mine goes off and a restart in the middle of a fill, neither may leave a fill to run over the
+//empty board the replant leaves, which would win it without a click.
+static void check_reveal_while_failing(void){
+        Board board;
+        board_create(&board, 30, 16, 30 * 16 * .2, 42069);
+        board.plant_threads = 1;
+        int tile_count = board.grid_width * board.grid_height;
+        board_reveal(&board, 15, 8);
+        board_fill(&board, INT_MAX);
+        int mine = 0;
+        while(!test_flags(board.tiles[mine], charged)) ++mine;
+        int safe = 0;
+        while(board.tiles[safe] != hidden) ++safe;
+        if(board_reveal(&board, mine % board.grid_width, mine / board.grid_width) != reveal_exploded) crash("a mine didn't go off");
+        board_step(&board);
+        if(board_reveal(&board, safe % board.grid_width, safe / board.grid_width) != reveal_ignored) crash("a click went through during an explosion");
+        while(board.failing != not_exploding) board_step(&board);
+        if(board.filling || board_won(&board) || board.hidden_safe_tiles != tile_count) crash("a click during an explosion carried over the replant");
+
+        board_reveal(&board, 15, 8);
+        board_fill(&board, 1);
+        if(!board.filling) crash("the fill finished before the restart");
+        board_restart(&board);
+        while(board.failing != not_exploding) board_step(&board);
+        if(board.filling || board_won(&board) || board.hidden_safe_tiles != tile_count) crash("a fill carried over the replant");
+        board_destroy(&board);
+}
+
+int main(void){
+        for(uint64_t i = 0; i < ARRAY_SIZE(sizes); ++i){
+                Board_Size size = sizes[i];
+                uint64_t tile_count = (uint64_t)size.width * size.height;
+                Board board;
+                board_create(&board, size.width, size.height, tile_count * 0.2, 42069);
+
+                int plant_runs = 1 + (1 << 24) / tile_count;
+                int threads = board.plant_threads;
+                board.plant_threads = 1;
+                uint64_t start = now_ns();
+                for(int run = 0; run < plant_runs; ++run) board_plant(&board);
+                report("plant 1 thread", size, (now_ns() - start) / plant_runs, tile_count);
+
+                //the same seed has to give the same board on any number of threads.
+                Tile * single_threaded = malloc(sizeof(Tile) * tile_count);
+                memcpy(single_threaded, board.tiles, sizeof(Tile) * tile_count);
+                board.plant_threads = threads;
+                start = now_ns();
+                for(int run = 0; run < plant_runs; ++run) board_plant(&board);
+                report("plant all threads", size, (now_ns() - start) / plant_runs, tile_count);
+                rng_seed(&board.rng, board.seed);
+                for(int run = 0; run < plant_runs; ++run) board_plant(&board);
+                if(memcmp(single_threaded, board.tiles, sizeof(Tile) * tile_count)) crash("planting depends on the thread count");
+                free(single_threaded);
+                if(board.unflagged_mines != board.total_mines) crash("planted the wrong number of mines");
+                board_verify(&board);
+
+                board_clear(&board);
+                start = now_ns();
+                board_reveal(&board, size.width / 2, size.height / 2);
+                report("first click plant", size, now_ns() - start, tile_count);
+                if(board_tile(&board, size.width / 2, size.height / 2) != none) crash("the first click wasn't safe");
+                board_plant(&board);
+
+                uint64_t steps;
+                start = now_ns();
+                uint64_t revealed = reveal_everything(&board, 1, &steps);
+                report("reveal 20% mines", size, now_ns() - start, revealed);
+
+                int won_runs = 1 + (1 << 26) / tile_count;
+                int won = 0;
+                start = now_ns();
+                for(int run = 0; run < won_runs; ++run) won += board_check_won(&board);
+                report("win check", size, (now_ns() - start) / won_runs, tile_count);
+                if(won) crash("won a board with no flags");
+                board_verify(&board);
+
+                //the bit plane layout against the Tile array.
+                for(uint64_t tile = 0; tile < tile_count; ++tile){
+                        if(test_flags(board.tiles[tile], charged)) board_flag(&board, tile % size.width, tile / size.width);
+                }
+                if(!board_won(&board)) crash("counters didn't see the board was won");
+                board_verify(&board);
+                Bit_Board bits;
+                bit_board_create(&bits, size.width, size.height);
+                start = now_ns();
+                bit_board_pack(&bits, &board);
+                report("bits pack", size, now_ns() - start, tile_count);
+
+                int count_runs = 1 + (1 << 24) / tile_count;
+                start = now_ns();
+                for(int run = 0; run < count_runs; ++run) board_count_mines(&board);
+                report("count mines tiles", size, (now_ns() - start) / count_runs, tile_count);
+
+                uint8_t * bit_counts = malloc(tile_count);
+                start = now_ns();
+                for(int run = 0; run < count_runs; ++run) bit_board_count_mines(&bits, bit_counts);
+                report("count mines bits", size, (now_ns() - start) / count_runs, tile_count);
+                if(memcmp(bit_counts, board.mine_counts, tile_count)) crash("bit board mine counts don't match");
+                free(bit_counts);
+
+                won = 0;
+                start = now_ns();
+                for(int run = 0; run < won_runs; ++run) won += board_check_won(&board);
+                report("win check won tiles", size, (now_ns() - start) / won_runs, tile_count);
+                if(won != won_runs) crash("didn't win a finished board");
+
+                won = 0;
+                start = now_ns();
+                for(int run = 0; run < won_runs; ++run) won += bit_board_check_won(&bits);
+                report("win check won bits", size, (now_ns() - start) / won_runs, tile_count);
+                if(won != won_runs) crash("bit board didn't win a finished board");
+                bit_board_destroy(&bits);
+
+                //the delta table against the bounds checked lookup it stands in for off the border.
+                int neighbor_runs = 1 + (1 << 24) / tile_count;
+                uint64_t neighbor_sum = 0;
+                start = now_ns();
+                for(int run = 0; run < neighbor_runs; ++run){
+                        for(int y = 0; y < size.height; ++y){
+                                for(int x = 0; x < size.width; ++x){
+                                        int neighbors[6];
+                                        int count = board_neighbors(&board, x, y, neighbors);
+                                        for(int n = 0; n < count; ++n) neighbor_sum += neighbors[n];
+                                }
+                        }
+                }
+                report("neighbors", size, (now_ns() - start) / neighbor_runs, tile_count);
+                //every tile through the bounds checks, the way every lookup went before the deltas.
+                uint64_t checked_sum = 0;
+                start = now_ns();
+                for(int run = 0; run < neighbor_runs; ++run){
+                        for(int y = 0; y < size.height; ++y){
+                                for(int x = 0; x < size.width; ++x){
+                                        int neighbors[6];
+                                        int count = board_border_neighbors(&board, x, y, neighbors);
+                                        for(int n = 0; n < count; ++n) checked_sum += neighbors[n];
+                                }
+                        }
+                }
+                report("neighbors checked", size, (now_ns() - start) / neighbor_runs, tile_count);
+                if(neighbor_sum != checked_sum) crash("neighbor deltas disagree with the bounds checks");
+
+                //moving mines keeps the counts right without a recount.
+                int moves = tile_count / 8 + 1;
+                Rng move_rng;
+                rng_seed(&move_rng, 7);
+                start = now_ns();
+                for(int move = 0; move < moves; ++move){
+                        int tile = rng_below(&move_rng, tile_count);
+                        board_set_mine(&board, tile, !test_flags(board.tiles[tile], charged));
+                }
+                report("move mines", size, now_ns() - start, moves);
+                uint8_t * moved_counts = malloc(tile_count);
+                memcpy(moved_counts, board.mine_counts, tile_count);
+                board_count_mines(&board);
+                if(memcmp(moved_counts, board.mine_counts, tile_count)) crash("moving mines left the counts wrong");
+                free(moved_counts);
+                board_verify(&board);
+
+                board.total_mines = 0;
+                board_plant(&board);
+                start = now_ns();
+                revealed = reveal_everything(&board, 1, &steps);
+                report("reveal empty board", size, now_ns() - start, revealed);
+                if(revealed != tile_count) crash("flood fill missed tiles");
+                board_verify(&board);
+
+                board_plant(&board);
+                start = now_ns();
+                revealed = reveal_everything(&board, 0, &steps);
+                report("reveal empty by ring", size, now_ns() - start, revealed);
+                printf("%-22s %5dx%-5d %12llu steps\n", "", size.width, size.height, (unsigned long long)steps);
+                if(revealed != tile_count) crash("flood fill missed tiles");
+
+                board_destroy(&board);
+                puts("");
+        }
+        bench_chunks();
+        puts("");
+        bench_snapshots();
+        puts("");
+        bench_solver();
+        puts("");
+        bench_rounds();
+        check_reveal_while_failing();
+        check_picking();
+}
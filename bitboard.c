@@ -0,0 +1,249 @@
+#include <string.h>
+#include "bitboard.h"
+#include "common.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+void bit_board_create(Bit_Board * bits, int grid_width, int grid_height){
+        *bits = (Bit_Board){0};
+        bits->grid_width = grid_width;
+        bits->grid_height = grid_height;
+        bits->words_per_row = (grid_width + 63) / 64;
+
+        size_t plane_size = sizeof(uint64_t) * bits->words_per_row * grid_height;
+        bits->hidden = calloc(1, plane_size);
+        bits->charged = calloc(1, plane_size);
+        bits->flagged = calloc(1, plane_size);
+        if(!bits->hidden || !bits->charged || !bits->flagged) crash("out of memory for the bit board");
+}
+
+void bit_board_destroy(Bit_Board * bits){
+        free(bits->hidden);
+        free(bits->charged);
+        free(bits->flagged);
+        *bits = (Bit_Board){0};
+}
+
+void bit_board_pack(Bit_Board * bits, Board const * board){
+        for(int y = 0; y < bits->grid_height; ++y){
+                Tile const * row = board->tiles + y * board->grid_width;
+                uint64_t * hidden_row = bits->hidden + y * bits->words_per_row;
+                uint64_t * charged_row = bits->charged + y * bits->words_per_row;
+                uint64_t * flagged_row = bits->flagged + y * bits->words_per_row;
+                for(int word = 0; word < bits->words_per_row; ++word){
+                        uint64_t h = 0, c = 0, f = 0;
+                        int end = bits->grid_width - word * 64;
+                        if(end > 64) end = 64;
+                        for(int bit = 0; bit < end; ++bit){
+                                Tile tile = row[word * 64 + bit];
+                                h |= (uint64_t)test_flags(tile, hidden) << bit;
+                                c |= (uint64_t)test_flags(tile, charged) << bit;
+                                f |= (uint64_t)test_flags(tile, flagged) << bit;
+                        }
+                        hidden_row[word] = h;
+                        charged_row[word] = c;
+                        flagged_row[word] = f;
+                }
+        }
+}
+
+//bit x of the result is tile x-1 of the row.
+static void shift_west(uint64_t * out, uint64_t const * row, int words){
+        uint64_t carry = 0;
+        for(int i = 0; i < words; ++i){
+                out[i] = (row[i] << 1) | carry;
+                carry = row[i] >> 63;
+        }
+}
+
+//bit x of the result is tile x+1 of the row.
+static void shift_east(uint64_t * out, uint64_t const * row, int words){
+        for(int i = 0; i < words; ++i){
+                uint64_t next = i + 1 < words ? row[i + 1] : 0;
+                out[i] = (row[i] >> 1) | (next << 63);
+        }
+}
+
+//bit sliced sum of six one bit inputs into three bit planes.
+static inline void add6_word(uint64_t * ones, uint64_t * twos, uint64_t * fours,
+                uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t e, uint64_t f){
+        uint64_t sum_abc = a ^ b ^ c;
+        uint64_t carry_abc = (a & b) | (c & (a ^ b));
+        uint64_t sum_def = d ^ e ^ f;
+        uint64_t carry_def = (d & e) | (f & (d ^ e));
+        uint64_t carry_ones = sum_abc & sum_def;
+        *ones = sum_abc ^ sum_def;
+        *twos = carry_abc ^ carry_def ^ carry_ones;
+        *fours = (carry_abc & carry_def) | (carry_ones & (carry_abc ^ carry_def));
+}
+
+static void add6(uint64_t * ones, uint64_t * twos, uint64_t * fours, uint64_t * const in[6], int words){
+        int i = 0;
+#if defined(__AVX2__)
+        for(; i + 4 <= words; i += 4){
+                __m256i a = _mm256_loadu_si256((__m256i const *)(in[0] + i));
+                __m256i b = _mm256_loadu_si256((__m256i const *)(in[1] + i));
+                __m256i c = _mm256_loadu_si256((__m256i const *)(in[2] + i));
+                __m256i d = _mm256_loadu_si256((__m256i const *)(in[3] + i));
+                __m256i e = _mm256_loadu_si256((__m256i const *)(in[4] + i));
+                __m256i f = _mm256_loadu_si256((__m256i const *)(in[5] + i));
+                __m256i sum_abc = _mm256_xor_si256(_mm256_xor_si256(a, b), c);
+                __m256i carry_abc = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_xor_si256(a, b)));
+                __m256i sum_def = _mm256_xor_si256(_mm256_xor_si256(d, e), f);
+                __m256i carry_def = _mm256_or_si256(_mm256_and_si256(d, e), _mm256_and_si256(f, _mm256_xor_si256(d, e)));
+                __m256i carry_ones = _mm256_and_si256(sum_abc, sum_def);
+                _mm256_storeu_si256((__m256i *)(ones + i), _mm256_xor_si256(sum_abc, sum_def));
+                _mm256_storeu_si256((__m256i *)(twos + i), _mm256_xor_si256(_mm256_xor_si256(carry_abc, carry_def), carry_ones));
+                _mm256_storeu_si256((__m256i *)(fours + i), _mm256_or_si256(_mm256_and_si256(carry_abc, carry_def),
+                                        _mm256_and_si256(carry_ones, _mm256_xor_si256(carry_abc, carry_def))));
+        }
+#elif defined(__SSE2__)
+        for(; i + 2 <= words; i += 2){
+                __m128i a = _mm_loadu_si128((__m128i const *)(in[0] + i));
+                __m128i b = _mm_loadu_si128((__m128i const *)(in[1] + i));
+                __m128i c = _mm_loadu_si128((__m128i const *)(in[2] + i));
+                __m128i d = _mm_loadu_si128((__m128i const *)(in[3] + i));
+                __m128i e = _mm_loadu_si128((__m128i const *)(in[4] + i));
+                __m128i f = _mm_loadu_si128((__m128i const *)(in[5] + i));
+                __m128i sum_abc = _mm_xor_si128(_mm_xor_si128(a, b), c);
+                __m128i carry_abc = _mm_or_si128(_mm_and_si128(a, b), _mm_and_si128(c, _mm_xor_si128(a, b)));
+                __m128i sum_def = _mm_xor_si128(_mm_xor_si128(d, e), f);
+                __m128i carry_def = _mm_or_si128(_mm_and_si128(d, e), _mm_and_si128(f, _mm_xor_si128(d, e)));
+                __m128i carry_ones = _mm_and_si128(sum_abc, sum_def);
+                _mm_storeu_si128((__m128i *)(ones + i), _mm_xor_si128(sum_abc, sum_def));
+                _mm_storeu_si128((__m128i *)(twos + i), _mm_xor_si128(_mm_xor_si128(carry_abc, carry_def), carry_ones));
+                _mm_storeu_si128((__m128i *)(fours + i), _mm_or_si128(_mm_and_si128(carry_abc, carry_def),
+                                        _mm_and_si128(carry_ones, _mm_xor_si128(carry_abc, carry_def))));
+        }
+#elif defined(__wasm_simd128__)
+        for(; i + 2 <= words; i += 2){
+                v128_t a = wasm_v128_load(in[0] + i);
+                v128_t b = wasm_v128_load(in[1] + i);
+                v128_t c = wasm_v128_load(in[2] + i);
+                v128_t d = wasm_v128_load(in[3] + i);
+                v128_t e = wasm_v128_load(in[4] + i);
+                v128_t f = wasm_v128_load(in[5] + i);
+                v128_t sum_abc = wasm_v128_xor(wasm_v128_xor(a, b), c);
+                v128_t carry_abc = wasm_v128_or(wasm_v128_and(a, b), wasm_v128_and(c, wasm_v128_xor(a, b)));
+                v128_t sum_def = wasm_v128_xor(wasm_v128_xor(d, e), f);
+                v128_t carry_def = wasm_v128_or(wasm_v128_and(d, e), wasm_v128_and(f, wasm_v128_xor(d, e)));
+                v128_t carry_ones = wasm_v128_and(sum_abc, sum_def);
+                wasm_v128_store(ones + i, wasm_v128_xor(sum_abc, sum_def));
+                wasm_v128_store(twos + i, wasm_v128_xor(wasm_v128_xor(carry_abc, carry_def), carry_ones));
+                wasm_v128_store(fours + i, wasm_v128_or(wasm_v128_and(carry_abc, carry_def),
+                                        wasm_v128_and(carry_ones, wasm_v128_xor(carry_abc, carry_def))));
+        }
+#endif
+        for(; i < words; ++i){
+                add6_word(ones + i, twos + i, fours + i, in[0][i], in[1][i], in[2][i], in[3][i], in[4][i], in[5][i]);
+        }
+}
+
+//byte i of spread_bits[b] is bit i of b, turns 8 bits into 8 one byte counts at once.
+static uint64_t spread_bits[256];
+
+static void init_spread_bits(void){
+        if(spread_bits[255]) return;
+        for(int b = 0; b < 256; ++b){
+                uint64_t spread = 0;
+                for(int bit = 0; bit < 8; ++bit) spread |= (uint64_t)((b >> bit) & 1) << (bit * 8);
+                spread_bits[b] = spread;
+        }
+}
+
+void bit_board_count_mines(Bit_Board const * bits, uint8_t * mine_counts){
+        init_spread_bits();
+        int words = bits->words_per_row;
+
+        //six neighbor planes and three count planes for the row being counted.
+        uint64_t * scratch = calloc(9 * words + 1, sizeof(uint64_t));
+        if(!scratch) crash("out of memory for the bit board");
+        uint64_t * in[6];
+        for(int i = 0; i < 6; ++i) in[i] = scratch + i * words;
+        uint64_t * ones = scratch + 6 * words;
+        uint64_t * twos = scratch + 7 * words;
+        uint64_t * fours = scratch + 8 * words;
+
+        for(int y = 0; y < bits->grid_height; ++y){
+                uint64_t const * row = bits->charged + y * words;
+                shift_west(in[0], row, words);
+                shift_east(in[1], row, words);
+
+                //odd rows sit half a tile east, so their neighbors above and below are x and x+1, even rows x-1 and x.
+                for(int side = 0; side < 2; ++side){
+                        int other_y = side ? y + 1 : y - 1;
+                        uint64_t * near = in[2 + side * 2];
+                        uint64_t * far = in[3 + side * 2];
+                        if(other_y < 0 || other_y >= bits->grid_height){
+                                memset(near, 0, sizeof(uint64_t) * words);
+                                memset(far, 0, sizeof(uint64_t) * words);
+                                continue;
+                        }
+                        uint64_t const * other = bits->charged + other_y * words;
+                        memcpy(near, other, sizeof(uint64_t) * words);
+                        if(y & 1) shift_east(far, other, words);
+                        else shift_west(far, other, words);
+                }
+
+                add6(ones, twos, fours, in, words);
+
+                uint8_t * counts = mine_counts + (size_t)y * bits->grid_width;
+                for(int x = 0; x < bits->grid_width; x += 8){
+                        int word = x / 64, shift = x % 64;
+                        uint64_t packed = spread_bits[(ones[word] >> shift) & 0xff]
+                                | spread_bits[(twos[word] >> shift) & 0xff] << 1
+                                | spread_bits[(fours[word] >> shift) & 0xff] << 2;
+                        int count = bits->grid_width - x < 8 ? bits->grid_width - x : 8;
+                        //byte i of packed is the count for tile x + i.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+                        if(count == 8){
+                                memcpy(counts + x, &packed, 8);
+                                continue;
+                        }
+#endif
+                        for(int i = 0; i < count; ++i) counts[x + i] = packed >> (i * 8);
+                }
+        }
+        free(scratch);
+}
+
+int bit_board_check_won(Bit_Board const * bits){
+        size_t words = (size_t)bits->words_per_row * bits->grid_height;
+        size_t i = 0;
+        //any charged tile without a flag or any safe tile still hidden.
+        uint64_t losing = 0;
+#if defined(__AVX2__)
+        __m256i losing_wide = _mm256_setzero_si256();
+        for(; i + 4 <= words; i += 4){
+                __m256i h = _mm256_loadu_si256((__m256i const *)(bits->hidden + i));
+                __m256i c = _mm256_loadu_si256((__m256i const *)(bits->charged + i));
+                __m256i f = _mm256_loadu_si256((__m256i const *)(bits->flagged + i));
+                losing_wide = _mm256_or_si256(losing_wide, _mm256_or_si256(_mm256_andnot_si256(f, c), _mm256_andnot_si256(c, h)));
+        }
+        losing = !_mm256_testz_si256(losing_wide, losing_wide);
+#elif defined(__SSE2__)
+        __m128i losing_wide = _mm_setzero_si128();
+        for(; i + 2 <= words; i += 2){
+                __m128i h = _mm_loadu_si128((__m128i const *)(bits->hidden + i));
+                __m128i c = _mm_loadu_si128((__m128i const *)(bits->charged + i));
+                __m128i f = _mm_loadu_si128((__m128i const *)(bits->flagged + i));
+                losing_wide = _mm_or_si128(losing_wide, _mm_or_si128(_mm_andnot_si128(f, c), _mm_andnot_si128(c, h)));
+        }
+        losing = _mm_movemask_epi8(_mm_cmpeq_epi8(losing_wide, _mm_setzero_si128())) != 0xffff;
+#elif defined(__wasm_simd128__)
+        v128_t losing_wide = wasm_i64x2_splat(0);
+        for(; i + 2 <= words; i += 2){
+                v128_t h = wasm_v128_load(bits->hidden + i);
+                v128_t c = wasm_v128_load(bits->charged + i);
+                v128_t f = wasm_v128_load(bits->flagged + i);
+                losing_wide = wasm_v128_or(losing_wide, wasm_v128_or(wasm_v128_andnot(c, f), wasm_v128_andnot(h, c)));
+        }
+        losing = wasm_v128_any_true(losing_wide);
+#endif
+        for(; i < words; ++i) losing |= (bits->charged[i] & ~bits->flagged[i]) | (bits->hidden[i] & ~bits->charged[i]);
+        return !losing;
+}
@@ -0,0 +1,31 @@
+#ifndef SWEEP_BITBOARD_H
+#define SWEEP_BITBOARD_H
+
+#include <stdint.h>
+#include "board.h"
+
+//Board flags packed one bit per tile, one plane per flag, row by row.
+//bit x % 64 of word x / 64 in a row is tile x, bits past grid_width are always 0.
+
+typedef struct{
+        int grid_width, grid_height;
+        int words_per_row;
+
+        //sizeof words_per_row * grid_height;
+        uint64_t * hidden;
+        uint64_t * charged;
+        uint64_t * flagged;
+} Bit_Board;
+
+void bit_board_create(Bit_Board * bits, int grid_width, int grid_height);
+void bit_board_destroy(Bit_Board * bits);
+
+void bit_board_pack(Bit_Board * bits, Board const * board);
+
+//neighbor mine counts for every tile, a row at a time so only three rows of planes are hot.
+void bit_board_count_mines(Bit_Board const * bits, uint8_t * mine_counts);
+
+//same answer as board_check_won.
+int bit_board_check_won(Bit_Board const * bits);
+
+#endif
@@ -0,0 +1,390 @@
+#include "board.h"
+#include "generate.h"
+#include "plant.h"
+#include "snapshot.h"
+#include "thread.h"
+#include "common.h"
+
+#if defined(SWEEP_COUNT_ALLOCATIONS)
+uint64_t allocation_count;
+#endif
+
+#if defined(SWEEP_VERIFY)
+#define VERIFY(board) board_verify(board)
+#else
+#define VERIFY(board)
+#endif
+
+static inline void count_tile(Board * board, Tile tile, int sign){
+        int is_hidden = test_flags(tile, hidden);
+        int is_charged = test_flags(tile, charged);
+        int is_flagged = test_flags(tile, flagged);
+        board->hidden_safe_tiles += sign * (is_hidden & !is_charged);
+        board->unflagged_mines += sign * (is_charged & !is_flagged);
+        board->flagged_mines += sign * (is_charged & is_flagged);
+        board->wrong_flags += sign * (is_flagged & !is_charged);
+}
+
+//every tile change goes through here so the counters stay right.
+static inline void set_tile(Board * board, int tile_index, Tile tile){
+        count_tile(board, board->tiles[tile_index], -1);
+        board->tiles[tile_index] = tile;
+        count_tile(board, tile, 1);
+        board->row_changes[tile_index / board->grid_width] = ++board->changes;
+}
+
+//drops whatever the fill had left to search, nothing may carry over into a board the tiles no longer match.
+static inline void stop_fill(Board * board){
+        board->filling = 0;
+        board->fill_head = board->fill_tail = 0;
+}
+
+//the arrays a fill touches together come first, the planting scratch last.
+static size_t tile_memory(int grid_width, int grid_height){
+        size_t tile_count = (size_t)grid_width * grid_height;
+        return arena_bytes(sizeof(Tile) * tile_count) + arena_bytes(tile_count);
+}
+
+static size_t scratch_memory(int grid_width, int grid_height){
+        size_t tile_count = (size_t)grid_width * grid_height;
+        return arena_bytes(sizeof(uint64_t) * grid_height)
+                + arena_bytes(sizeof(int) * tile_count)
+                + 2 * arena_bytes(sizeof(int) * plant_band_count(grid_width, grid_height));
+}
+
+size_t board_memory(int grid_width, int grid_height){
+        return tile_memory(grid_width, grid_height) + scratch_memory(grid_width, grid_height);
+}
+
+void board_lay_out(Board * board){
+        int grid_width = board->grid_width;
+        int grid_height = board->grid_height;
+        size_t tile_count = (size_t)grid_width * grid_height;
+        size_t size = scratch_memory(grid_width, grid_height) + (board->mapping ? 0 : tile_memory(grid_width, grid_height));
+        if(size > board->arena.size){
+                arena_destroy(&board->arena);
+                arena_create(&board->arena, size);
+        }
+        arena_reset(&board->arena);
+
+        if(!board->mapping){
+                board->tiles = arena_push(&board->arena, sizeof(Tile) * tile_count);
+                board->mine_counts = arena_push(&board->arena, tile_count);
+        }
+        board->row_changes = arena_push(&board->arena, sizeof(uint64_t) * grid_height);
+        //every tile is revealed when it's queued so it can only be queued once per fill.
+        board->tiles_to_search = arena_push(&board->arena, sizeof(int) * tile_count);
+        int band_count = plant_band_count(grid_width, grid_height);
+        board->band_mines = arena_push(&board->arena, sizeof(int) * band_count);
+        board->band_space = arena_push(&board->arena, sizeof(int) * band_count);
+
+        //a table per tile would be 24 bytes a tile, two rows of deltas cover every tile off the border.
+        for(int odd = 0; odd < 2; ++odd){
+                int * deltas = board->neighbor_deltas[odd];
+                deltas[0] = -1;
+                deltas[1] = 1;
+                deltas[2] = -grid_width - !odd;
+                deltas[3] = -grid_width + odd;
+                deltas[4] = grid_width - !odd;
+                deltas[5] = grid_width + odd;
+        }
+}
+
+void board_create(Board * board, int grid_width, int grid_height, int total_mines, uint64_t seed){
+        *board = (Board){0};
+        board->grid_width = grid_width;
+        board->grid_height = grid_height;
+        board->total_mines = total_mines;
+        board->seed = seed;
+        rng_seed(&board->rng, seed);
+        board->first_click_safe = 1;
+        board->plant_threads = hardware_threads();
+
+        board_lay_out(board);
+        board_clear(board);
+}
+
+void board_destroy(Board * board){
+        if(board->mapping) snapshot_unmap(board->mapping, board->mapping_size);
+        arena_destroy(&board->arena);
+        *board = (Board){0};
+}
+
+void board_resize(Board * board, int grid_width, int grid_height, int total_mines){
+        if(board->mapping){
+                snapshot_unmap(board->mapping, board->mapping_size);
+                board->mapping = NULL;
+                board->mapping_size = 0;
+        }
+        board->grid_width = grid_width;
+        board->grid_height = grid_height;
+        board->total_mines = total_mines;
+        board_lay_out(board);
+        board->failing = not_exploding;
+        board->exploding_mine_index = 0;
+        board->clearing_row_index = 0;
+        board_clear(board);
+        if(!board->first_click_safe) board_plant(board);
+}
+
+void board_clear(Board * board){
+        int tile_count = board->grid_width * board->grid_height;
+        for(int i = 0; i < tile_count; ++i) board->tiles[i] = hidden;
+        for(int i = 0; i < tile_count; ++i) board->mine_counts[i] = 0;
+        board->hidden_safe_tiles = tile_count;
+        board->unflagged_mines = 0;
+        board->flagged_mines = 0;
+        board->wrong_flags = 0;
+        board->planted = 0;
+        stop_fill(board);
+        board_touch_rows(board, 0, board->grid_height);
+}
+
+void board_touch_rows(Board * board, int first_row, int end_row){
+        ++board->changes;
+        for(int y = first_row; y < end_row; ++y) board->row_changes[y] = board->changes;
+}
+
+void board_plant(Board * board){
+        stop_fill(board);
+        plant_mines(board, rng_next(&board->rng), NULL, 0, board->plant_threads);
+        board->planted = 1;
+        VERIFY(board);
+}
+
+void board_plant_around(Board * board, int x, int y){
+        if(!board->no_guess || !generate_no_guess(board, x, y, board->plant_threads, NO_GUESS_SECONDS, NULL)){
+                int excluded[PLANT_MAX_EXCLUDED];
+                excluded[0] = board_tile_index(board, x, y);
+                int excluded_count = 1 + board_neighbors(board, x, y, excluded + 1);
+                plant_mines(board, rng_next(&board->rng), excluded, excluded_count, board->plant_threads);
+        }
+        board->planted = 1;
+        VERIFY(board);
+}
+
+int board_border_neighbors(Board const * board, int x, int y, int neighbors[6]){
+        int count = 0;
+        int offset_left_x = (x-!(y&1));
+        int offset_right_x = (x+(y&1));
+        if(x > 0) neighbors[count++] = y * board->grid_width + x-1;
+        if(x+1 < board->grid_width) neighbors[count++] = y * board->grid_width + x+1;
+        for(int other_y = y-1; other_y <= y+1; other_y += 2){
+                if(other_y < 0 || other_y >= board->grid_height) continue;
+                if(offset_left_x >= 0) neighbors[count++] = other_y * board->grid_width + offset_left_x;
+                if(offset_right_x < board->grid_width) neighbors[count++] = other_y * board->grid_width + offset_right_x;
+        }
+        return count;
+}
+
+void board_count_mines(Board * board){
+        board_count_mines_rows(board, 0, board->grid_height);
+}
+
+//mines around one tile with every bounds check, for the border.
+static uint8_t count_around(Board const * board, int x, int y){
+        int neighbors[6];
+        int count = board_border_neighbors(board, x, y, neighbors);
+        uint8_t mines_found = 0;
+        for(int i = 0; i < count; ++i) mines_found += test_flags(board->tiles[neighbors[i]], charged);
+        return mines_found;
+}
+
+//one straight pass per row, the inner loop has no branches so the compiler can vectorize it.
+void board_count_mines_rows(Board * board, int first_row, int end_row){
+        int grid_width = board->grid_width;
+        for(int y = first_row; y < end_row; ++y){
+                uint8_t * restrict counts = board->mine_counts + y * grid_width;
+                if(y == 0 || y + 1 == board->grid_height || grid_width < 3){
+                        for(int x = 0; x < grid_width; ++x) counts[x] = count_around(board, x, y);
+                        continue;
+                }
+                //up[x] and up[x+1] are the two neighbors above x, the same for down.
+                Tile const * restrict row = board->tiles + y * grid_width;
+                Tile const * restrict up = row - grid_width - !(y&1);
+                Tile const * restrict down = row + grid_width - !(y&1);
+                counts[0] = count_around(board, 0, y);
+                for(int x = 1; x + 1 < grid_width; ++x){
+                        counts[x] = test_flags(row[x-1], charged) + test_flags(row[x+1], charged)
+                                + test_flags(up[x], charged) + test_flags(up[x+1], charged)
+                                + test_flags(down[x], charged) + test_flags(down[x+1], charged);
+                }
+                counts[grid_width-1] = count_around(board, grid_width-1, y);
+        }
+}
+
+void board_set_mine(Board * board, int tile_index, int mine){
+        Tile tile = board->tiles[tile_index];
+        if(test_flags(tile, charged) == !!mine) return;
+        set_tile(board, tile_index, tile ^ charged);
+        int x = tile_index % board->grid_width;
+        int y = tile_index / board->grid_width;
+        int neighbors[6];
+        int count = board_neighbors(board, x, y, neighbors);
+        int change = mine ? 1 : -1;
+        for(int i = 0; i < count; ++i) board->mine_counts[neighbors[i]] += change;
+        //the counts changed on the rows either side too, so whatever mirrors them redoes those.
+        board_touch_rows(board, y > 0 ? y - 1 : 0, y + 2 < board->grid_height ? y + 2 : board->grid_height);
+}
+
+//reveals a hidden tile and queues it so the fill looks at its neighbors.
+static inline void queue_reveal(Board * board, int tile_index){
+        set_tile(board, tile_index, board->tiles[tile_index] & ~hidden);
+        board->tiles_to_search[board->fill_tail++] = tile_index;
+}
+
+int board_fill(Board * board, int budget){
+        int done = 0;
+        for(; done < budget && board->fill_head < board->fill_tail; ++done){
+                int tile_index = board->tiles_to_search[board->fill_head++];
+                if(board->mine_counts[tile_index] > 0) continue;
+
+                int x = tile_index % board->grid_width;
+                int y = tile_index / board->grid_width;
+                int neighbors[6];
+                int count = board_neighbors(board, x, y, neighbors);
+
+                //no mines around so every hidden neighbor is safe, flagged or not.
+                for(int i = 0; i < count; ++i){
+                        if(test_flags(board->tiles[neighbors[i]], hidden)) queue_reveal(board, neighbors[i]);
+                }
+        }
+        if(board->fill_head == board->fill_tail) board->filling = 0;
+        VERIFY(board);
+        return done;
+}
+
+Reveal_Result board_reveal(Board * board, int x, int y){
+        //a click while the board blows up or replants would fill over a board that's about to be cleared.
+        if(board->filling || board->failing != not_exploding) return reveal_ignored;
+
+        if(!board->planted) board_plant_around(board, x, y);
+
+        int tile_index = board_tile_index(board, x, y);
+        Tile tile = board->tiles[tile_index];
+        if(test_flags(tile, charged) && !test_flags(tile, flagged)){
+                board->failing = exploding;
+                stop_fill(board);
+                return reveal_exploded;
+        }else if(tile == hidden){
+                board->fill_head = 0;
+                board->fill_tail = 0;
+                queue_reveal(board, tile_index);
+                board->filling = 1;
+                return reveal_filling;
+        }
+        return reveal_ignored;
+}
+
+void board_flag(Board * board, int x, int y){
+        int tile_index = board_tile_index(board, x, y);
+        set_tile(board, tile_index, board->tiles[tile_index] ^ flagged);
+        VERIFY(board);
+}
+
+void board_restart(Board * board){
+        board->failing = re_planting;
+        stop_fill(board);
+}
+
+//explosions and replants finish in about this many steps however big the board is,
+//small boards still go a mine or a row per step.
+#define ANIMATION_STEPS (int)(ANIMATION_SECONDS * BOARD_STEPS_PER_SECOND)
+
+static void step_exploding(Board * board){
+        int max_tiles = board->grid_width * board->grid_height;
+        int mines_left = board->total_mines / ANIMATION_STEPS + 1;
+        if(board->exploding_mine_index == max_tiles){
+                board->exploding_mine_index = 0;
+                board->failing = re_planting;
+        }else for(;board->exploding_mine_index < max_tiles && mines_left > 0; ++board->exploding_mine_index){
+                if(test_flags(board->tiles[board->exploding_mine_index], charged)){
+                        set_tile(board, board->exploding_mine_index, board->tiles[board->exploding_mine_index] & ~hidden);
+                        --mines_left;
+                }
+        }
+}
+
+static void step_re_planting(Board * board){
+        if(board->clearing_row_index < board->grid_height){
+                int end_row = board->clearing_row_index + board->grid_height / ANIMATION_STEPS + 1;
+                if(end_row > board->grid_height) end_row = board->grid_height;
+                //taking the mines out one by one keeps the counts right for a click before the replant finishes.
+                for(int tile_index = board->clearing_row_index * board->grid_width; tile_index < end_row * board->grid_width; ++tile_index){
+                        board_set_mine(board, tile_index, 0);
+                        set_tile(board, tile_index, hidden);
+                }
+                board->clearing_row_index = end_row;
+        }else if(board->clearing_row_index == board->grid_height){
+                //the rows are already clear, plant now or wait for the first click.
+                board->planted = 0;
+                if(!board->first_click_safe) board_plant(board);
+                board->clearing_row_index = 0;
+                board->failing = not_exploding;
+        }
+}
+
+void board_step(Board * board){
+        if(board->failing == exploding) step_exploding(board);
+        else if(board->failing == re_planting) step_re_planting(board);
+        else if(board->filling) board_fill(board, board_fill_frontier(board));
+        VERIFY(board);
+}
+
+int board_check_won(Board const * board){
+        int won = 1;
+        for(Tile const * tile = board->tiles; tile != board->tiles + (board->grid_width * board->grid_height); ++tile){
+                if(test_flags(*tile, charged) && !test_flags(*tile, flagged)){
+                        won = 0;
+                } else if(test_flags(*tile, hidden) && !test_flags(*tile, charged)){
+                        won = 0;
+                }
+        }
+        return won;
+}
+
+static inline uint64_t hash_value(uint64_t hash, uint64_t value){
+        return (hash ^ value) * 0x100000001b3;
+}
+
+uint64_t board_hash(Board const * board){
+        uint64_t hash = 0xcbf29ce484222325;
+        int tile_count = board->grid_width * board->grid_height;
+        for(int i = 0; i < tile_count; ++i) hash = hash_value(hash, board->tiles[i]);
+        for(int i = 0; i < tile_count; ++i) hash = hash_value(hash, board->mine_counts[i]);
+        int const state[] = {
+                board->grid_width, board->grid_height, board->total_mines, board->planted,
+                board->hidden_safe_tiles, board->unflagged_mines, board->flagged_mines, board->wrong_flags,
+                board->failing, board->exploding_mine_index, board->clearing_row_index, board->filling,
+                board->filling ? board_fill_frontier(board) : 0,
+        };
+        for(uint64_t i = 0; i < ARRAY_SIZE(state); ++i) hash = hash_value(hash, (uint32_t)state[i]);
+        for(int i = 0; i < 4; ++i) hash = hash_value(hash, board->rng.s[i]);
+        return hash;
+}
+
+void board_recount(Board * board){
+        board->hidden_safe_tiles = 0;
+        board->unflagged_mines = 0;
+        board->flagged_mines = 0;
+        board->wrong_flags = 0;
+        for(int i = 0; i < board->grid_width * board->grid_height; ++i) count_tile(board, board->tiles[i], 1);
+}
+
+void board_verify(Board const * board){
+        Board recount = *board;
+        board_recount(&recount);
+        if(recount.hidden_safe_tiles != board->hidden_safe_tiles
+                        || recount.unflagged_mines != board->unflagged_mines
+                        || recount.flagged_mines != board->flagged_mines
+                        || recount.wrong_flags != board->wrong_flags){
+                crash("board counters drifted from the tiles");
+        }
+        if(board_won(board) != board_check_won(board)) crash("board_won disagrees with the full scan");
+        if(!board->planted) return;
+        for(int y = 0; y < board->grid_height; ++y){
+                for(int x = 0; x < board->grid_width; ++x){
+                        if(board_mine_count(board, x, y) != count_around(board, x, y)) crash("mine counts drifted from the mines");
+                }
+        }
+}
@@ -0,0 +1,179 @@
+#ifndef SWEEP_BOARD_H
+#define SWEEP_BOARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "arena.h"
+#include "rng.h"
+
+//The simulation, no glfw or gl in here so it can run headless.
+
+//board_step is meant to run this many times a second whatever the frame rate, game_simulate keeps it there.
+#define BOARD_STEPS_PER_SECOND 120
+//an explosion or a replant takes about this long however big the board is, each step does its share.
+#define ANIMATION_SECONDS .4
+
+//how long a first click with no_guess set may wait on the generator.
+#define NO_GUESS_SECONDS 2.0
+
+typedef enum{
+        none = 0,
+        hidden = 1 << 0,
+        charged = 1 << 1,
+        flagged = 1 << 3,
+} Tile;
+
+typedef enum{
+        not_exploding,
+        exploding,
+        re_planting
+} Failing;
+
+typedef enum{
+        reveal_ignored,
+        reveal_filling,
+        reveal_exploded,
+} Reveal_Result;
+
+typedef struct{
+        int grid_width, grid_height;
+        int total_mines;
+
+        //every planting draws its seed from rng, so a board seed gives the same sequence of boards.
+        uint64_t seed;
+        Rng rng;
+        int planted;
+        //plant on the first reveal so the clicked tile and its neighbors are never mines.
+        int first_click_safe;
+        //and plant that first reveal so the rest can be solved without guessing, see generate.h.
+        int no_guess;
+        int plant_threads;
+
+        //every array below lives in arena, one block sized by board_memory so a restart or a resize that fits never allocates.
+        Arena arena;
+
+        //sizeof width * height;
+        Tile * tiles;
+        uint8_t * mine_counts;
+        //set when tiles and mine_counts point into a snapshot file instead of their own allocations, see snapshot.h.
+        void * mapping;
+        size_t mapping_size;
+
+        //bumped on every tile change, row_changes[y] is the value it had when row y last changed.
+        //anything mirroring the board keeps the last value it saw and redoes rows newer than that.
+        uint64_t changes;
+        uint64_t * row_changes;
+
+        //kept up to date on every tile change so winning is O(1).
+        int hidden_safe_tiles;
+        int unflagged_mines;
+        int flagged_mines;
+        int wrong_flags;
+
+        Failing failing;
+        int exploding_mine_index;
+        int clearing_row_index;
+        int filling;
+        //breadth first queue, tiles in [fill_head, fill_tail) are revealed but their neighbors aren't checked yet.
+        int * tiles_to_search;
+        int fill_head, fill_tail;
+
+        //planting's per band scratch, see plant.h.
+        int * band_mines;
+        int * band_space;
+
+        //index deltas from a tile to its six neighbors in board_neighbors order, for even rows then odd ones.
+        //every tile off the border has all six, so only border tiles need bounds checks.
+        int neighbor_deltas[2][6];
+} Board;
+
+//the board starts cleared, see first_click_safe.
+void board_create(Board * board, int grid_width, int grid_height, int total_mines, uint64_t seed);
+void board_destroy(Board * board);
+//bytes of the block a board this size keeps its arrays in.
+size_t board_memory(int grid_width, int grid_height);
+//points the arrays into the block for the board's size, growing the block only when it's too small.
+//tiles and mine_counts are left alone on a mapped board.
+void board_lay_out(Board * board);
+//a cleared board of the new size, dropping any mapping. it only allocates when board_memory outgrows the block.
+void board_resize(Board * board, int grid_width, int grid_height, int total_mines);
+
+//hides every tile and takes every mine off the board.
+void board_clear(Board * board);
+//hides every tile and charges exactly total_mines random ones.
+void board_plant(Board * board);
+//same but x, y and its neighbors stay safe. with no_guess set it tries for a board that can be finished from
+//x, y without guessing for NO_GUESS_SECONDS, and plants a random one if that runs out.
+void board_plant_around(Board * board, int x, int y);
+
+//marks rows [first_row, end_row) changed, for code that writes tiles without going through the board.
+void board_touch_rows(Board * board, int first_row, int end_row);
+
+//board_neighbors with a bounds check on every neighbor, right for any tile but only needed on the border.
+int board_border_neighbors(Board const * board, int x, int y, int neighbors[6]);
+//charges or clears one tile and moves the mine counts of its neighbors with it, without recounting anything.
+void board_set_mine(Board * board, int tile_index, int mine);
+
+//fills mine_counts for every tile, planting does this so the flood fill never has to count.
+void board_count_mines(Board * board);
+void board_count_mines_rows(Board * board, int first_row, int end_row);
+
+//starts a flood fill from a hidden tile or sets off the mine under it. ignored while a fill, explosion or replant runs.
+Reveal_Result board_reveal(Board * board, int x, int y);
+void board_flag(Board * board, int x, int y);
+//clears the board a row at a time then plants it again.
+void board_restart(Board * board);
+
+//advances the explode and replant state machines by one unit and the flood fill by one ring.
+void board_step(Board * board);
+//works through up to budget tiles of the flood fill and returns how many it did, pass INT_MAX to finish it.
+int board_fill(Board * board, int budget);
+//full scan of the board, every charged tile flagged and every safe one revealed.
+int board_check_won(Board const * board);
+//fnv-1a over the tiles, mine counts, counters, state machines and rng, two runs that end on the same hash ended on the same board.
+uint64_t board_hash(Board const * board);
+//sets the counters from the tiles, for a board whose tiles came from somewhere else.
+void board_recount(Board * board);
+//recounts the counters from the tiles and crashes if they drifted, build with SWEEP_VERIFY to run it on every change.
+void board_verify(Board const * board);
+
+static inline int board_won(Board const * board){
+        return board->hidden_safe_tiles == 0 && board->unflagged_mines == 0;
+}
+
+static inline int board_tile_index(Board const * board, int x, int y){
+        return y * board->grid_width + x;
+}
+
+static inline int board_on_border(Board const * board, int x, int y){
+        return x == 0 || y == 0 || x + 1 == board->grid_width || y + 1 == board->grid_height;
+}
+
+//tile indices of the up to six neighbors of x, y, returns how many there are. off the border it's the delta table.
+static inline int board_neighbors(Board const * board, int x, int y, int neighbors[6]){
+        if(board_on_border(board, x, y)) return board_border_neighbors(board, x, y, neighbors);
+        int tile_index = board_tile_index(board, x, y);
+        int const * deltas = board->neighbor_deltas[y & 1];
+        for(int i = 0; i < 6; ++i) neighbors[i] = tile_index + deltas[i];
+        return 6;
+}
+
+static inline Tile board_tile(Board const * board, int x, int y){
+        return board->tiles[board_tile_index(board, x, y)];
+}
+
+static inline int board_mine_count(Board const * board, int x, int y){
+        return board->mine_counts[board_tile_index(board, x, y)];
+}
+
+//how many tiles the fill has queued but not looked at, the outer ring of the region so far.
+static inline int board_fill_frontier(Board const * board){
+        return board->fill_tail - board->fill_head;
+}
+
+//the tile the flood fill looks at next, -1 when it isn't filling.
+static inline int board_search_tile(Board const * board){
+        return board->filling ? board->tiles_to_search[board->fill_head] : -1;
+}
+
+#endif
@@ -0,0 +1,176 @@
+#include <string.h>
+#include "bot.h"
+#include "solver.h"
+
+static inline int unopened(Tile tile){
+        return test_flags(tile, hidden) && !test_flags(tile, flagged);
+}
+
+//a random tile that passes is_candidate, a few random tries first then a scan from a random start.
+static int random_tile(Rng * rng, int tile_count, int (*is_candidate)(void const * data, int tile), void const * data){
+        for(int attempt = 0; attempt < 64; ++attempt){
+                int tile = rng_below(rng, tile_count);
+                if(is_candidate(data, tile)) return tile;
+        }
+        int start = rng_below(rng, tile_count);
+        for(int i = 0; i < tile_count; ++i){
+                int tile = (start + i) % tile_count;
+                if(is_candidate(data, tile)) return tile;
+        }
+        return -1;
+}
+
+static size_t no_memory(int grid_width, int grid_height){
+        (void)grid_width;
+        (void)grid_height;
+        return 0;
+}
+
+static void * create_nothing(Arena * arena, int grid_width, int grid_height){
+        (void)arena;
+        (void)grid_width;
+        (void)grid_height;
+        return NULL;
+}
+
+static void start_nothing(void * bot, Board const * board){
+        (void)bot;
+        (void)board;
+}
+
+static int board_unopened(void const * board, int tile){
+        return unopened(((Board const *)board)->tiles[tile]);
+}
+
+//clicks anywhere it hasn't yet, the baseline every other bot should beat.
+static Move random_move(void * bot, Board const * board, Rng * rng){
+        (void)bot;
+        Move move = {.kind = move_reveal, .guess = 1};
+        move.tile = random_tile(rng, board->grid_width * board->grid_height, board_unopened, board);
+        if(move.tile < 0) crash("the random bot has nothing left to click");
+        return move;
+}
+
+typedef struct{
+        Solver solver;
+        //decided[played] is the next decision to make on the board.
+        int played;
+        //last move's guess, it was safe if the game is still going so the solver can learn it.
+        int guessed;
+        int lowest_odds;
+} Solver_Bot;
+
+static size_t solver_bot_memory(int grid_width, int grid_height){
+        return arena_bytes(sizeof(Solver_Bot)) + solver_memory(grid_width, grid_height);
+}
+
+static void * create_solver_bot(Arena * arena, int grid_width, int grid_height, int lowest_odds){
+        Solver_Bot * bot = arena_push(arena, sizeof(Solver_Bot));
+        solver_create_in(&bot->solver, grid_width, grid_height, arena);
+        bot->lowest_odds = lowest_odds;
+        return bot;
+}
+
+static void * create_random_guesser(Arena * arena, int grid_width, int grid_height){
+        return create_solver_bot(arena, grid_width, grid_height, 0);
+}
+
+static void * create_odds_guesser(Arena * arena, int grid_width, int grid_height){
+        return create_solver_bot(arena, grid_width, grid_height, 1);
+}
+
+static void start_solver_bot(void * bot_p, Board const * board){
+        Solver_Bot * bot = bot_p;
+        solver_reset(&bot->solver, board);
+        int tile_count = board->grid_width * board->grid_height;
+        for(int tile = 0; tile < tile_count; ++tile){
+                if(!test_flags(board->tiles[tile], hidden)) solver_learn(&bot->solver, board, tile);
+        }
+        bot->played = bot->solver.decided_count;
+        bot->guessed = -1;
+}
+
+static int solver_unknown_tile(void const * solver, int tile){
+        return ((Solver const *)solver)->cells[tile] == solver_unknown;
+}
+
+//the unknown tile least likely to be a mine. a tile next to numbers is as likely as the worst of them makes it,
+//remaining mines over unknown neighbors, one away from every number gets the mines nobody has found spread over
+//every unknown tile. ties go to a random one.
+static int lowest_odds_tile(Solver const * solver, Board const * board, Rng * rng){
+        int tile_count = board->grid_width * board->grid_height;
+        int unknown_count = 0;
+        int found_mines = 0;
+        for(int tile = 0; tile < tile_count; ++tile){
+                unknown_count += solver->cells[tile] == solver_unknown;
+                found_mines += solver->cells[tile] == solver_mine;
+        }
+        double unseen_odds = unknown_count ? (double)(board->total_mines - found_mines) / unknown_count : 1;
+
+        int best = -1;
+        double best_odds = 2;
+        int ties = 0;
+        for(int tile = 0; tile < tile_count; ++tile){
+                if(solver->cells[tile] != solver_unknown) continue;
+                int neighbors[6];
+                int count = board_neighbors(board, tile % board->grid_width, tile / board->grid_width, neighbors);
+                double odds = -1;
+                for(int i = 0; i < count; ++i){
+                        int number = neighbors[i];
+                        if(solver->cells[number] != solver_safe) continue;
+                        double number_odds = (double)(board->mine_counts[number] - solver->mines_around[number]) / solver->unknown_around[number];
+                        if(number_odds > odds) odds = number_odds;
+                }
+                if(odds < 0) odds = unseen_odds;
+                if(odds < best_odds){
+                        best_odds = odds;
+                        best = tile;
+                        ties = 1;
+                }else if(odds == best_odds && rng_below(rng, ++ties) == 0){
+                        best = tile;
+                }
+        }
+        return best;
+}
+
+//plays everything the solver can prove, then guesses.
+static Move solver_bot_move(void * bot_p, Board const * board, Rng * rng){
+        Solver_Bot * bot = bot_p;
+        Solver * solver = &bot->solver;
+        if(bot->guessed >= 0){
+                solver_learn(solver, board, bot->guessed);
+                bot->guessed = -1;
+        }
+        for(;;){
+                while(bot->played < solver->decided_count){
+                        int tile = solver->decided[bot->played++];
+                        //the board's fill opens what the solver opens around zeros, before the solver gets to it.
+                        if(!unopened(board->tiles[tile])) continue;
+                        Move move = {.kind = solver->cells[tile] == solver_mine ? move_flag : move_reveal, .tile = tile};
+                        return move;
+                }
+                int decided = solver->decided_count;
+                solver_think(solver, board);
+                if(solver->decided_count == decided) break;
+        }
+
+        Move move = {.kind = move_reveal, .guess = 1};
+        move.tile = bot->lowest_odds
+                ? lowest_odds_tile(solver, board, rng)
+                : random_tile(rng, board->grid_width * board->grid_height, solver_unknown_tile, solver);
+        if(move.tile < 0) crash("the solver bot has nothing left to guess");
+        bot->guessed = move.tile;
+        return move;
+}
+
+Bot const bots[] = {
+        {"random", no_memory, create_nothing, start_nothing, random_move},
+        {"solver_random_guess", solver_bot_memory, create_random_guesser, start_solver_bot, solver_bot_move},
+        {"solver", solver_bot_memory, create_odds_guesser, start_solver_bot, solver_bot_move},
+};
+int const bot_count = ARRAY_SIZE(bots);
+
+Bot const * bot_named(c_str name){
+        for(int i = 0; i < bot_count; ++i) if(!strcmp(bots[i].name, name)) return &bots[i];
+        return NULL;
+}
@@ -0,0 +1,43 @@
+#ifndef SWEEP_BOT_H
+#define SWEEP_BOT_H
+
+#include <stddef.h>
+#include "arena.h"
+#include "board.h"
+#include "common.h"
+#include "rng.h"
+
+//Players for sweep_batch. A bot only looks at what a player sees, which tiles are hidden or flagged and the
+//numbers on revealed ones, and its moves go through board_reveal and board_flag the same as clicks.
+
+typedef enum{
+        move_reveal,
+        move_flag,
+} Move_Kind;
+
+typedef struct{
+        Move_Kind kind;
+        int tile;
+        //a reveal the bot couldn't prove safe.
+        int guess;
+} Move;
+
+typedef struct{
+        c_str name;
+        //bytes create takes from the arena for a board this size.
+        size_t (*memory)(int grid_width, int grid_height);
+        //sets up what the bot keeps between moves, once per thread.
+        void * (*create)(Arena * arena, int grid_width, int grid_height);
+        //a new game on board, after the first click's fill finished.
+        void (*start)(void * bot, Board const * board);
+        //the next move on a board that's neither won nor lost, with every fill finished.
+        Move (*move)(void * bot, Board const * board, Rng * rng);
+} Bot;
+
+extern Bot const bots[];
+extern int const bot_count;
+
+//NULL when there's no bot called name.
+Bot const * bot_named(c_str name);
+
+#endif
@@ -0,0 +1,291 @@
+#include <stdlib.h>
+#include <string.h>
+#include "chunk.h"
+#include "rng.h"
+#include "common.h"
+
+static uint64_t chunk_hash(int64_t chunk_x, int64_t chunk_y){
+        uint64_t key = (uint64_t)chunk_x * 0x9e3779b97f4a7c15 ^ (uint64_t)chunk_y;
+        return splitmix64(&key);
+}
+
+static inline int local_index(int64_t x, int64_t y){
+        return (y & (CHUNK_SIZE - 1)) * CHUNK_SIZE + (x & (CHUNK_SIZE - 1));
+}
+
+//revealed or flagged, what makes a chunk worth keeping.
+static inline int tile_changed(Tile tile){
+        return !test_flags(tile, hidden) || test_flags(tile, flagged);
+}
+
+//the part of the chunk on the board gets its share of mines, placed only from the seed and chunk coordinates.
+static void generate_chunk(Chunk_Board const * board, Chunk * chunk){
+        int64_t first_x = chunk->chunk_x << CHUNK_BITS;
+        int64_t first_y = chunk->chunk_y << CHUNK_BITS;
+        int width = board->grid_width - first_x < CHUNK_SIZE ? board->grid_width - first_x : CHUNK_SIZE;
+        int height = board->grid_height - first_y < CHUNK_SIZE ? board->grid_height - first_y : CHUNK_SIZE;
+        memset(chunk->tiles, hidden, sizeof(chunk->tiles));
+        memset(chunk->mine_counts, 0, sizeof(chunk->mine_counts));
+
+        int space = width * height;
+        int mines = board->mine_density * space + .5;
+        Rng rng;
+        rng_seed(&rng, board->seed ^ chunk_hash(chunk->chunk_x, chunk->chunk_y));
+        //Floyd's sampling over the on board tiles, the charged bit doubles as the set of picked tiles.
+        for(int j = space - mines; j < space; ++j){
+                int pick = rng_below(&rng, j + 1);
+                int tile = pick / width * CHUNK_SIZE + pick % width;
+                if(test_flags(chunk->tiles[tile], charged)) tile = j / width * CHUNK_SIZE + j % width;
+                chunk->tiles[tile] |= charged;
+        }
+
+        for(int i = 0; i < board->safe_count; ++i){
+                Tile_Position safe = board->safe_tiles[i];
+                if(safe.x >> CHUNK_BITS == chunk->chunk_x && safe.y >> CHUNK_BITS == chunk->chunk_y) chunk->tiles[local_index(safe.x, safe.y)] &= ~charged;
+        }
+}
+
+static void grow_buckets(Chunk_Board * board){
+        uint64_t bucket_count = board->bucket_count * 2;
+        Chunk ** buckets = calloc(bucket_count, sizeof(Chunk *));
+        if(!buckets) crash("out of memory for the chunk table");
+        for(uint64_t i = 0; i < board->bucket_count; ++i){
+                for(Chunk * chunk = board->buckets[i], * next; chunk; chunk = next){
+                        next = chunk->next;
+                        uint64_t bucket = chunk_hash(chunk->chunk_x, chunk->chunk_y) & (bucket_count - 1);
+                        chunk->next = buckets[bucket];
+                        buckets[bucket] = chunk;
+                }
+        }
+        free(board->buckets);
+        board->buckets = buckets;
+        board->bucket_count = bucket_count;
+}
+
+//the chunk holding x, y, made if it isn't resident. never evicts so pointers stay good until the call that does.
+static Chunk * find_chunk(Chunk_Board * board, int64_t x, int64_t y){
+        int64_t chunk_x = x >> CHUNK_BITS;
+        int64_t chunk_y = y >> CHUNK_BITS;
+        Chunk * chunk = board->last_chunk;
+        if(!chunk || chunk->chunk_x != chunk_x || chunk->chunk_y != chunk_y){
+                uint64_t bucket = chunk_hash(chunk_x, chunk_y) & (board->bucket_count - 1);
+                for(chunk = board->buckets[bucket]; chunk; chunk = chunk->next){
+                        if(chunk->chunk_x == chunk_x && chunk->chunk_y == chunk_y) break;
+                }
+                if(!chunk){
+                        if(board->chunk_count >= board->bucket_count){
+                                grow_buckets(board);
+                                bucket = chunk_hash(chunk_x, chunk_y) & (board->bucket_count - 1);
+                        }
+                        chunk = malloc(sizeof(Chunk));
+                        if(!chunk) crash("out of memory for a chunk");
+                        chunk->chunk_x = chunk_x;
+                        chunk->chunk_y = chunk_y;
+                        chunk->changed_tiles = 0;
+                        generate_chunk(board, chunk);
+                        chunk->next = board->buckets[bucket];
+                        board->buckets[bucket] = chunk;
+                        ++board->chunk_count;
+                        ++board->clean_chunks;
+                        ++board->generated_chunks;
+                }
+                board->last_chunk = chunk;
+        }
+        chunk->last_used = ++board->uses;
+        return chunk;
+}
+
+//every tile change goes through here so the clean count stays right.
+static void set_tile(Chunk_Board * board, Chunk * chunk, int tile_index, Tile tile){
+        int change = tile_changed(tile) - tile_changed(chunk->tiles[tile_index]);
+        chunk->tiles[tile_index] = tile;
+        if(!change) return;
+        if(!chunk->changed_tiles) --board->clean_chunks;
+        chunk->changed_tiles += change;
+        if(!chunk->changed_tiles) ++board->clean_chunks;
+}
+
+//evicting on the way out of every call that makes chunks keeps memory down without invalidating anything mid call.
+static void trim(Chunk_Board * board){
+        if(board->clean_chunks > board->max_clean_chunks) chunk_board_evict(board, board->max_clean_chunks / 2);
+}
+
+void chunk_board_create(Chunk_Board * board, int64_t grid_width, int64_t grid_height, double mine_density, uint64_t seed, uint64_t max_clean_chunks){
+        *board = (Chunk_Board){0};
+        board->grid_width = grid_width;
+        board->grid_height = grid_height;
+        board->mine_density = mine_density;
+        board->seed = seed;
+        board->max_clean_chunks = max_clean_chunks;
+
+        board->bucket_count = 1 << 10;
+        board->buckets = calloc(board->bucket_count, sizeof(Chunk *));
+        board->fill_capacity = 1 << 10;
+        board->fill_queue = malloc(sizeof(Tile_Position) * board->fill_capacity);
+        if(!board->buckets || !board->fill_queue) crash("out of memory for the chunk board");
+}
+
+void chunk_board_destroy(Chunk_Board * board){
+        for(uint64_t i = 0; i < board->bucket_count; ++i){
+                for(Chunk * chunk = board->buckets[i], * next; chunk; chunk = next){
+                        next = chunk->next;
+                        free(chunk);
+                }
+        }
+        free(board->buckets);
+        free(board->fill_queue);
+        *board = (Chunk_Board){0};
+}
+
+Tile chunk_board_tile(Chunk_Board * board, int64_t x, int64_t y){
+        return find_chunk(board, x, y)->tiles[local_index(x, y)];
+}
+
+uint8_t chunk_board_mine_count(Chunk_Board * board, int64_t x, int64_t y){
+        return find_chunk(board, x, y)->mine_counts[local_index(x, y)];
+}
+
+int chunk_board_neighbors(Chunk_Board const * board, int64_t x, int64_t y, Tile_Position neighbors[6]){
+        int count = 0;
+        int64_t offset_left_x = x - !(y & 1);
+        int64_t offset_right_x = x + (y & 1);
+        if(x > 0) neighbors[count++] = (Tile_Position){x - 1, y};
+        if(x + 1 < board->grid_width) neighbors[count++] = (Tile_Position){x + 1, y};
+        for(int64_t other_y = y - 1; other_y <= y + 1; other_y += 2){
+                if(other_y < 0 || other_y >= board->grid_height) continue;
+                if(offset_left_x >= 0) neighbors[count++] = (Tile_Position){offset_left_x, other_y};
+                if(offset_right_x < board->grid_width) neighbors[count++] = (Tile_Position){offset_right_x, other_y};
+        }
+        return count;
+}
+
+//reveals a hidden tile, counts the mines around it, and queues it so the fill looks at its neighbors.
+static void queue_reveal(Chunk_Board * board, int64_t x, int64_t y){
+        Chunk * chunk = find_chunk(board, x, y);
+        int tile_index = local_index(x, y);
+        set_tile(board, chunk, tile_index, chunk->tiles[tile_index] & ~hidden);
+        ++board->revealed_tiles;
+
+        //the neighbors can be in up to three other chunks, made clean if they aren't resident.
+        Tile_Position neighbors[6];
+        int count = chunk_board_neighbors(board, x, y, neighbors);
+        uint8_t mines_found = 0;
+        for(int i = 0; i < count; ++i) mines_found += test_flags(chunk_board_tile(board, neighbors[i].x, neighbors[i].y), charged);
+        chunk->mine_counts[tile_index] = mines_found;
+
+        if(board->fill_tail - board->fill_head == board->fill_capacity){
+                Tile_Position * fill_queue = malloc(sizeof(Tile_Position) * board->fill_capacity * 2);
+                if(!fill_queue) crash("out of memory for the flood fill");
+                for(uint64_t i = board->fill_head; i < board->fill_tail; ++i){
+                        fill_queue[i - board->fill_head] = board->fill_queue[i & (board->fill_capacity - 1)];
+                }
+                free(board->fill_queue);
+                board->fill_queue = fill_queue;
+                board->fill_tail -= board->fill_head;
+                board->fill_head = 0;
+                board->fill_capacity *= 2;
+        }
+        board->fill_queue[board->fill_tail++ & (board->fill_capacity - 1)] = (Tile_Position){x, y};
+}
+
+//takes the mines out from under the first reveal, in chunks already made and in any made later.
+static void plant_safe(Chunk_Board * board, int64_t x, int64_t y){
+        board->planted = 1;
+        board->safe_tiles[0] = (Tile_Position){x, y};
+        board->safe_count = 1 + chunk_board_neighbors(board, x, y, board->safe_tiles + 1);
+        for(int i = 0; i < board->safe_count; ++i){
+                Tile_Position safe = board->safe_tiles[i];
+                Chunk * chunk = find_chunk(board, safe.x, safe.y);
+                chunk->tiles[local_index(safe.x, safe.y)] &= ~charged;
+        }
+}
+
+Reveal_Result chunk_board_reveal(Chunk_Board * board, int64_t x, int64_t y){
+        if(board->filling) return reveal_ignored;
+
+        if(!board->planted) plant_safe(board, x, y);
+
+        Reveal_Result result = reveal_ignored;
+        Tile tile = chunk_board_tile(board, x, y);
+        if(test_flags(tile, charged) && !test_flags(tile, flagged)){
+                board->exploded = 1;
+                result = reveal_exploded;
+        }else if(tile == hidden){
+                board->fill_head = 0;
+                board->fill_tail = 0;
+                queue_reveal(board, x, y);
+                board->filling = 1;
+                result = reveal_filling;
+        }
+        trim(board);
+        return result;
+}
+
+void chunk_board_flag(Chunk_Board * board, int64_t x, int64_t y){
+        Chunk * chunk = find_chunk(board, x, y);
+        int tile_index = local_index(x, y);
+        set_tile(board, chunk, tile_index, chunk->tiles[tile_index] ^ flagged);
+        trim(board);
+}
+
+uint64_t chunk_board_fill(Chunk_Board * board, uint64_t budget){
+        uint64_t done = 0;
+        for(; done < budget && board->fill_head < board->fill_tail; ++done){
+                Tile_Position tile = board->fill_queue[board->fill_head++ & (board->fill_capacity - 1)];
+                if(chunk_board_mine_count(board, tile.x, tile.y) > 0) continue;
+
+                //no mines around so every hidden neighbor is safe, flagged or not.
+                Tile_Position neighbors[6];
+                int count = chunk_board_neighbors(board, tile.x, tile.y, neighbors);
+                for(int i = 0; i < count; ++i){
+                        if(test_flags(chunk_board_tile(board, neighbors[i].x, neighbors[i].y), hidden)) queue_reveal(board, neighbors[i].x, neighbors[i].y);
+                }
+        }
+        if(board->fill_head == board->fill_tail) board->filling = 0;
+        trim(board);
+        return done;
+}
+
+static int compare_uses(void const * a, void const * b){
+        uint64_t use_a = *(uint64_t const *)a, use_b = *(uint64_t const *)b;
+        return (use_a > use_b) - (use_a < use_b);
+}
+
+void chunk_board_evict(Chunk_Board * board, uint64_t keep){
+        if(board->clean_chunks <= keep) return;
+
+        //every lookup gets its own use number, so everything at or before the cutoff is exactly what has to go.
+        uint64_t * uses = malloc(sizeof(uint64_t) * board->clean_chunks);
+        if(!uses) crash("out of memory for eviction");
+        uint64_t count = 0;
+        for(uint64_t i = 0; i < board->bucket_count; ++i){
+                for(Chunk * chunk = board->buckets[i]; chunk; chunk = chunk->next){
+                        if(!chunk->changed_tiles) uses[count++] = chunk->last_used;
+                }
+        }
+        qsort(uses, count, sizeof(uint64_t), compare_uses);
+        uint64_t cutoff = uses[count - keep - 1];
+        free(uses);
+
+        for(uint64_t i = 0; i < board->bucket_count; ++i){
+                for(Chunk ** link = &board->buckets[i]; *link;){
+                        Chunk * chunk = *link;
+                        if(chunk->changed_tiles || chunk->last_used > cutoff){
+                                link = &chunk->next;
+                                continue;
+                        }
+                        *link = chunk->next;
+                        free(chunk);
+                        --board->chunk_count;
+                        --board->clean_chunks;
+                        ++board->evicted_chunks;
+                }
+        }
+        board->last_chunk = NULL;
+}
+
+uint64_t chunk_board_resident_bytes(Chunk_Board const * board){
+        return sizeof(Chunk) * board->chunk_count
+                + sizeof(Chunk *) * board->bucket_count
+                + sizeof(Tile_Position) * board->fill_capacity;
+}
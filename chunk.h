@@ -0,0 +1,88 @@
+#ifndef SWEEP_CHUNK_H
+#define SWEEP_CHUNK_H
+
+#include <stdint.h>
+#include "board.h"
+
+//Sparse storage for boards too big to hold as dense arrays, up to 2^62 tiles a side.
+//Tiles live in 64x64 chunks that are only made when something looks at them. A chunk's mines
+//come from the seed and its chunk coordinates alone, so a chunk nobody has revealed or flagged
+//in is clean and can be dropped and made again later. Memory grows with what's been explored.
+//Only sweep_bench drives it so far. The game, the renderers, planting and snapshots all work on the dense
+//Board, so a board this big can be revealed, flagged and filled through this API but not played in a window.
+
+#define CHUNK_BITS 6
+#define CHUNK_SIZE (1 << CHUNK_BITS)
+#define CHUNK_TILES (CHUNK_SIZE * CHUNK_SIZE)
+
+typedef struct{
+        int64_t x, y;
+} Tile_Position;
+
+typedef struct Chunk{
+        int64_t chunk_x, chunk_y;
+        //same flags as Board tiles, indexed by local y * CHUNK_SIZE + local x.
+        uint8_t tiles[CHUNK_TILES];
+        //only filled in for revealed tiles.
+        uint8_t mine_counts[CHUNK_TILES];
+        //revealed or flagged tiles, a chunk with none is clean.
+        int changed_tiles;
+        uint64_t last_used;
+        struct Chunk * next;
+} Chunk;
+
+typedef struct{
+        int64_t grid_width, grid_height;
+        double mine_density;
+        uint64_t seed;
+
+        //the first reveal and its neighbors are never mines, whenever their chunks get made.
+        int planted;
+        Tile_Position safe_tiles[7];
+        int safe_count;
+
+        //chunks hashed by their coordinates, chained.
+        Chunk ** buckets;
+        uint64_t bucket_count;
+        uint64_t chunk_count;
+        uint64_t clean_chunks;
+        //clean chunks past this are evicted, oldest first.
+        uint64_t max_clean_chunks;
+        uint64_t uses;
+        Chunk * last_chunk;
+
+        uint64_t generated_chunks;
+        uint64_t evicted_chunks;
+        uint64_t revealed_tiles;
+        int exploded;
+
+        //breadth first like board_fill, a growable ring of tiles to look at.
+        int filling;
+        Tile_Position * fill_queue;
+        uint64_t fill_capacity;
+        uint64_t fill_head, fill_tail;
+} Chunk_Board;
+
+void chunk_board_create(Chunk_Board * board, int64_t grid_width, int64_t grid_height, double mine_density, uint64_t seed, uint64_t max_clean_chunks);
+void chunk_board_destroy(Chunk_Board * board);
+
+//makes the chunk if it isn't resident, x and y have to be on the board.
+Tile chunk_board_tile(Chunk_Board * board, int64_t x, int64_t y);
+//only meaningful once the tile is revealed.
+uint8_t chunk_board_mine_count(Chunk_Board * board, int64_t x, int64_t y);
+
+//same neighbors in the same order as board_neighbors.
+int chunk_board_neighbors(Chunk_Board const * board, int64_t x, int64_t y, Tile_Position neighbors[6]);
+
+Reveal_Result chunk_board_reveal(Chunk_Board * board, int64_t x, int64_t y);
+void chunk_board_flag(Chunk_Board * board, int64_t x, int64_t y);
+
+//looks at up to budget tiles of the flood fill and returns how many it did.
+uint64_t chunk_board_fill(Chunk_Board * board, uint64_t budget);
+
+//evicts clean chunks, least recently used first, until no more than keep are left.
+void chunk_board_evict(Chunk_Board * board, uint64_t keep);
+
+uint64_t chunk_board_resident_bytes(Chunk_Board const * board);
+
+#endif
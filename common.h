@@ -0,0 +1,42 @@
+#ifndef SWEEP_COMMON_H
+#define SWEEP_COMMON_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef  char const * c_str;
+
+#define ARRAY_SIZE(array) sizeof(array)/sizeof(array[0])
+
+static inline void crash(c_str message){
+        fputs(message, stderr);
+        abort();
+}
+
+#if defined(SWEEP_COUNT_ALLOCATIONS)
+#include <stdint.h>
+//every malloc, calloc and realloc after this bumps allocation_count, so a check can prove a path never reaches the system allocator.
+//not atomic, only count on one thread.
+extern uint64_t allocation_count;
+static inline void * counted_malloc(size_t size){
+        ++allocation_count;
+        return malloc(size);
+}
+static inline void * counted_calloc(size_t count, size_t size){
+        ++allocation_count;
+        return calloc(count, size);
+}
+static inline void * counted_realloc(void * memory, size_t size){
+        ++allocation_count;
+        return realloc(memory, size);
+}
+#define malloc(size) counted_malloc(size)
+#define calloc(count, size) counted_calloc(count, size)
+#define realloc(memory, size) counted_realloc(memory, size)
+#endif
+
+static inline int test_flags(int flags, int bits){
+        return (flags & bits) == bits;
+}
+
+#endif
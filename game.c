@@ -0,0 +1,259 @@
+#include <math.h>
+#include <stdio.h>
+#include "game.h"
+#include "snapshot.h"
+#include "profile.h"
+#include "common.h"
+
+//the narrowest a tile can get on screen, this is what keeps the tiles in view bounded on huge boards.
+#define MIN_TILE_PIXELS 4
+//each scroll wheel click zooms by this much.
+#define ZOOM_STEP 1.1
+//how far the arrow keys pan per frame in clip space.
+#define PAN_STEP .02
+//how long a frame may spend on the flood fill when revealing instantly.
+#define FILL_BUDGET_SECONDS 0.008
+//the most board steps one frame runs, anything owed past that waits for the next frame.
+#define MAX_FRAME_STEPS 16
+//time owed past this is dropped, so a long stall doesn't turn into seconds of catching up.
+#define MAX_OWED_SECONDS .25
+//the size keys double or halve both sides within these.
+#define MIN_GRID_SIZE 4
+#define MAX_GRID_SIZE 4096
+//each difficulty key moves the mine density by this much, up to MAX_MINE_DENSITY.
+#define DENSITY_STEP .025
+#define MAX_MINE_DENSITY .9
+
+Vec2 board_extent(float hexagon_diameter, int grid_width, int grid_height){
+        float hex_width = hexagon_diameter * 0.866025404;
+        Vec2 extent = {grid_width * hex_width + hex_width/2, (grid_height - 1) * hexagon_diameter * .75 + hexagon_diameter};
+        return extent;
+}
+
+Vec2 screen_to_board(Camera camera, int screen_width, int screen_height, double x, double y){
+        Vec2 board = {
+                ((x / (screen_width * 0.5) - 1) - camera.offset.x) / camera.zoom,
+                ((y / (screen_height * 0.5) - 1) - camera.offset.y) / camera.zoom,
+        };
+        return board;
+}
+
+int pick_hexagon(float hexagon_diameter, int grid_width, int grid_height, double x, double y, int * tile_x, int * tile_y){
+        double radius = hexagon_diameter * 0.5;
+        double hex_width = hexagon_diameter * 0.866025404;
+
+        //center tile 0,0 on the origin and convert to axial coordinates.
+        x -= hex_width/2;
+        y -= radius;
+        double q = (x * 0.577350269 - y / 3.0) / radius;
+        double r = (y * 2.0 / 3.0) / radius;
+        double s = -q - r;
+
+        double round_q = floor(q + .5);
+        double round_r = floor(r + .5);
+        double round_s = floor(s + .5);
+        double q_error = fabs(round_q - q);
+        double r_error = fabs(round_r - r);
+        double s_error = fabs(round_s - s);
+        if(q_error > r_error && q_error > s_error) round_q = -round_r - round_s;
+        else if(r_error > s_error) round_r = -round_q - round_s;
+
+        //axial to the odd row offset layout.
+        int row = round_r;
+        int column = (int)round_q + (row - (row & 1)) / 2;
+        if(column < 0 || column >= grid_width || row < 0 || row >= grid_height) return 0;
+        *tile_x = column;
+        *tile_y = row;
+        return 1;
+}
+
+//zoomed out until the whole board fits or tiles hit MIN_TILE_PIXELS, zoomed in until one tile fills the window.
+static void zoom_limits(Game const * game, float * min_zoom, float * max_zoom){
+        Vec2 extent = board_extent(game->hexagon_diameter, game->board.grid_width, game->board.grid_height);
+        float hex_width = game->hexagon_diameter * 0.866025404;
+        float fit_zoom = fminf(2 / extent.x, 2 / extent.y);
+        float smallest_tile_zoom = 2.0f * MIN_TILE_PIXELS / (hex_width * fminf(game->screen_width, game->screen_height));
+        *min_zoom = fmaxf(fit_zoom, smallest_tile_zoom);
+        *max_zoom = fmaxf(*min_zoom, 2 / hex_width);
+}
+
+//zooms keeping the board under clip where it is.
+static void zoom_camera(Game * game, Vec2 clip, float factor){
+        Camera * camera = &game->camera;
+        float min_zoom, max_zoom;
+        zoom_limits(game, &min_zoom, &max_zoom);
+        float zoom = fminf(fmaxf(camera->zoom * factor, min_zoom), max_zoom);
+        camera->offset.x = clip.x - (clip.x - camera->offset.x) / camera->zoom * zoom;
+        camera->offset.y = clip.y - (clip.y - camera->offset.y) / camera->zoom * zoom;
+        camera->zoom = zoom;
+}
+
+//as far out as zoom_limits allows, centered on the board.
+static void reset_camera(Game * game){
+        float min_zoom, max_zoom;
+        zoom_limits(game, &min_zoom, &max_zoom);
+        Vec2 extent = board_extent(game->hexagon_diameter, game->board.grid_width, game->board.grid_height);
+        game->camera.zoom = min_zoom;
+        game->camera.offset = (Vec2){-extent.x/2 * min_zoom, -extent.y/2 * min_zoom};
+}
+
+void game_fit_board(Game * game){
+        int grid_width = game->board.grid_width;
+        //the width fits clip space at zoom 1, the camera takes care of the rest.
+        game->hexagon_diameter = (2.0-(2.0/(grid_width * 0.866025404) * 0.5 ))/(grid_width * 0.866025404);
+        reset_camera(game);
+}
+
+void game_create(Game * game, int grid_width, int grid_height, double mine_density, uint64_t seed, int screen_width, int screen_height){
+        *game = (Game){0};
+        game->mine_density = mine_density;
+        board_create(&game->board, grid_width, grid_height, (double)grid_height * grid_width * mine_density, seed);
+        game->screen_width = screen_width;
+        game->screen_height = screen_height;
+        game->hover_x = game->hover_y = -1;
+        game_fit_board(game);
+}
+
+void game_destroy(Game * game){
+        board_destroy(&game->board);
+        *game = (Game){0};
+}
+
+//the save key writes the rows that changed since the last save, the load key swaps the board for the saved one.
+static void snapshot_keys(Game * game, Input const * input){
+        if(game->snapshots_off) return;
+        Board * board = &game->board;
+        if(input_pressed(input, input_save)){
+                int saved = game->snapshot_saved
+                        ? snapshot_save_changes(board, SNAPSHOT_PATH, game->saved_changes)
+                        : snapshot_save(board, SNAPSHOT_PATH);
+                if(saved){
+                        game->snapshot_saved = 1;
+                        game->saved_changes = board->changes;
+                        printf("saved %s\n", SNAPSHOT_PATH);
+                }
+        }
+
+        Board loaded;
+        if(input_pressed(input, input_load) && snapshot_load(&loaded, SNAPSHOT_PATH)){
+                //the change count carries on so everything mirroring the old board redoes every row.
+                loaded.changes = board->changes;
+                loaded.no_guess = board->no_guess;
+                game->mine_density = (double)loaded.total_mines / ((double)loaded.grid_width * loaded.grid_height);
+                board_touch_rows(&loaded, 0, loaded.grid_height);
+                board_destroy(board);
+                *board = loaded;
+                game->snapshot_saved = 1;
+                game->saved_changes = board->changes;
+                game_fit_board(game);
+                printf("loaded %s\n", SNAPSHOT_PATH);
+        }
+}
+
+//boards started outside the limits from the command line only ever step towards them.
+static int step_grid_size(int size, int grow){
+        if(grow > 0 && size < MAX_GRID_SIZE) return size * 2 < MAX_GRID_SIZE ? size * 2 : MAX_GRID_SIZE;
+        if(grow < 0 && size > MIN_GRID_SIZE) return size / 2 > MIN_GRID_SIZE ? size / 2 : MIN_GRID_SIZE;
+        return size;
+}
+
+//a new round at the new size or density, in the board's block unless it grew past it.
+static void difficulty_keys(Game * game, Input const * input){
+        Board * board = &game->board;
+        int grow = input_pressed(input, input_grow) - input_pressed(input, input_shrink);
+        int harder = input_pressed(input, input_harder) - input_pressed(input, input_easier);
+        if(!grow && !harder) return;
+
+        int grid_width = step_grid_size(board->grid_width, grow);
+        int grid_height = step_grid_size(board->grid_height, grow);
+        game->mine_density = fmin(fmax(game->mine_density + harder * DENSITY_STEP, 0), MAX_MINE_DENSITY);
+        board_resize(board, grid_width, grid_height, (double)grid_width * grid_height * game->mine_density);
+        //the saved rows are for the old board.
+        game->snapshot_saved = 0;
+        game_fit_board(game);
+        printf("%dx%d with %.1f%% mines\n", grid_width, grid_height, game->mine_density * 100);
+}
+
+void game_input(Game * game, Input const * input){
+        game->screen_width = input->screen_width;
+        game->screen_height = input->screen_height;
+
+        if(input_held(input, input_restart)) board_restart(&game->board);
+        if(input_pressed(input, input_instant)) game->instant_reveal = !game->instant_reveal;
+        if(input_pressed(input, input_no_guess)){
+                game->board.no_guess = !game->board.no_guess;
+                printf("no guess boards %s from the next plant\n", game->board.no_guess ? "on" : "off");
+        }
+        snapshot_keys(game, input);
+        difficulty_keys(game, input);
+
+        //the wheel zooms around the cursor, the middle button drags and the arrow keys pan.
+        Vec2 cursor_clip = {input->cursor_x / (game->screen_width * 0.5) - 1, input->cursor_y / (game->screen_height * 0.5) - 1};
+        if(input->scroll != 0) zoom_camera(game, cursor_clip, pow(ZOOM_STEP, input->scroll));
+        int pan_button_pressed = input_held(input, input_pan);
+        if(game->panning && pan_button_pressed){
+                game->camera.offset.x += cursor_clip.x - game->pan_from.x;
+                game->camera.offset.y += cursor_clip.y - game->pan_from.y;
+        }
+        game->panning = pan_button_pressed;
+        game->pan_from = cursor_clip;
+        int pan_x = input_held(input, input_right) - input_held(input, input_left);
+        int pan_y = input_held(input, input_up) - input_held(input, input_down);
+        game->camera.offset.x -= pan_x * PAN_STEP;
+        game->camera.offset.y -= pan_y * PAN_STEP;
+        game->pan_keys_held = pan_x || pan_y;
+}
+
+void game_pick(Game * game, Input const * input){
+        game->hover_x = game->hover_y = -1;
+        Vec2 cursor_board = screen_to_board(game->camera, game->screen_width, game->screen_height, input->cursor_x, input->cursor_y);
+        pick_hexagon(game->hexagon_diameter, game->board.grid_width, game->board.grid_height, cursor_board.x, cursor_board.y, &game->hover_x, &game->hover_y);
+}
+
+//returns how many tiles it got through.
+static int fill_for(Board * board, double seconds){
+        int done = 0;
+        double start = profile_now();
+        while(board->filling && profile_now() - start < seconds) done += board_fill(board, 1 << 12);
+        return done;
+}
+
+//whole steps owed for the time since the last frame. time only builds up while something is moving, so the
+//first step after a quiet spell comes a frame after the click instead of catching up on the wait.
+static int steps_due(Game * game){
+        double now = profile_now();
+        if(game->animating) game->step_seconds += fmin(now - game->step_time, MAX_OWED_SECONDS);
+        else game->step_seconds = 0;
+        game->step_time = now;
+        int steps = game->step_seconds * BOARD_STEPS_PER_SECOND;
+        if(steps > MAX_FRAME_STEPS) steps = MAX_FRAME_STEPS;
+        game->step_seconds -= (double)steps / BOARD_STEPS_PER_SECOND;
+        game->late = game->step_seconds * BOARD_STEPS_PER_SECOND >= 1;
+        return steps;
+}
+
+double game_step_wait(Game const * game){
+        double wait = 1.0 / BOARD_STEPS_PER_SECOND - game->step_seconds - (profile_now() - game->step_time);
+        return wait > 0 ? wait : 0;
+}
+
+int game_simulate(Game * game, Input * input){
+        Board * board = &game->board;
+        if(!game->instant_reveal) input->fill_tiles = 0;
+        else if(input->fill_tiles < 0) input->fill_tiles = fill_for(board, FILL_BUDGET_SECONDS);
+        else board_fill(board, input->fill_tiles);
+        if(input->steps < 0) input->steps = steps_due(game);
+        else game->late = 0;
+        int touched = input->fill_tiles;
+        for(int step = 0; step < input->steps; ++step){
+                touched += board_fill_frontier(board);
+                board_step(board);
+        }
+
+        if(game->hover_x > -1 && !board->filling && board->failing == not_exploding){
+                if(input_pressed(input, input_sweep)) board_reveal(board, game->hover_x, game->hover_y);
+                else if(input_pressed(input, input_flag)) board_flag(board, game->hover_x, game->hover_y);
+        }
+        game->animating = board->failing != not_exploding || board->filling || game->pan_keys_held;
+        return touched;
+}
@@ -0,0 +1,81 @@
+#ifndef SWEEP_GAME_H
+#define SWEEP_GAME_H
+
+#include <stdint.h>
+#include "board.h"
+#include "input.h"
+
+//Everything a frame does before drawing: the camera, picking and the board. No glfw or gl in here,
+//it only sees Input, so sweep_replay can run it headless.
+
+typedef struct{
+        float x, y;
+} Vec2;
+
+//board space to clip space is board * zoom + offset, zoom 1 and offset -1,-1 puts the board's 0 to 2 on the window.
+typedef struct{
+        Vec2 offset;
+        float zoom;
+} Camera;
+
+typedef struct{
+        Board board;
+        //what the difficulty keys step, total_mines is this share of the tiles.
+        double mine_density;
+        //sized so the board's width is 2 in board space, see game_fit_board.
+        float hexagon_diameter;
+        int screen_width, screen_height;
+
+        Camera camera;
+        int panning;
+        Vec2 pan_from;
+        int pan_keys_held;
+
+        //finish flood fills as fast as the frame budget allows instead of a ring per frame.
+        int instant_reveal;
+        //the tile under the cursor, -1 when the cursor is off the board.
+        int hover_x, hover_y;
+        //something is moving on its own so keep polling instead of waiting for input.
+        int animating;
+        //time owed to board_step that hasn't made a whole step yet, and when it was last topped up.
+        double step_seconds;
+        double step_time;
+        //the frame ran out of steps before it caught up, the renderer can skip a frame to let it.
+        int late;
+
+        //the save and load keys do nothing, set while recording or replaying so a log never depends on
+        //what SNAPSHOT_PATH held at the time or leaves one behind.
+        int snapshots_off;
+        //SNAPSHOT_PATH holds this board as it was at saved_changes, so the next save only writes newer rows.
+        int snapshot_saved;
+        uint64_t saved_changes;
+} Game;
+
+//where the save key writes the board and the load key reads it.
+#define SNAPSHOT_PATH "sweep.snapshot"
+
+void game_create(Game * game, int grid_width, int grid_height, double mine_density, uint64_t seed, int screen_width, int screen_height);
+void game_destroy(Game * game);
+//sizes the hexagons for the board and frames all of it.
+void game_fit_board(Game * game);
+
+//the keys, the snapshot keys and the camera.
+void game_input(Game * game, Input const * input);
+//finds the tile under the cursor.
+void game_pick(Game * game, Input const * input);
+//steps the board at BOARD_STEPS_PER_SECOND and applies clicks. with live input it fills in input->steps, and
+//input->fill_tiles with instant reveal on. returns how many tiles the flood fill looked at or queued.
+int game_simulate(Game * game, Input * input);
+
+//seconds until the next board step is owed, 0 when it already is.
+double game_step_wait(Game const * game);
+
+//width and height of the board in board space.
+Vec2 board_extent(float hexagon_diameter, int grid_width, int grid_height);
+//x and y are window pixels with y going up.
+Vec2 screen_to_board(Camera camera, int screen_width, int screen_height, double x, double y);
+//the tile whose hexagon holds board space x, y, the inverse of calculate_hexagon_offset in main.c.
+//rounds in cube coordinates so it's exact up to the hexagon edges, returns 0 when off the board.
+int pick_hexagon(float hexagon_diameter, int grid_width, int grid_height, double x, double y, int * tile_x, int * tile_y);
+
+#endif
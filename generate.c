@@ -0,0 +1,112 @@
+#include <string.h>
+#include "generate.h"
+#include "solver.h"
+#include "plant.h"
+#include "thread.h"
+#include "profile.h"
+#include "common.h"
+
+typedef struct{
+        int x, y;
+        uint64_t seed;
+        int first_attempt;
+        double deadline;
+        //one board and solver per worker slot, reused round to round.
+        Board * slots;
+        Solver * solvers;
+        int * solved;
+        int * passes;
+        uint64_t * perturbations;
+} Generate_Job;
+
+static void run_attempt(void * job_p, int slot){
+        Generate_Job * job = job_p;
+        Board * board = &job->slots[slot];
+        Solver * solver = &job->solvers[slot];
+        uint64_t attempt_seed = job->seed ^ ((uint64_t)(job->first_attempt + slot) * 0xd1b54a32d192ed03);
+
+        int excluded[PLANT_MAX_EXCLUDED];
+        excluded[0] = board_tile_index(board, job->x, job->y);
+        int excluded_count = 1 + board_neighbors(board, job->x, job->y, excluded + 1);
+        //the attempts are the parallelism, so each plants on its own thread.
+        plant_mines(board, attempt_seed, excluded, excluded_count, 1);
+
+        Rng rng;
+        rng_seed(&rng, ~attempt_seed);
+        solver->deadline = job->deadline;
+        //a repairing solve that moved nothing was a clean solve, otherwise it takes another to be sure.
+        int solved = 0;
+        int pass = 0;
+        uint64_t perturbations = 0;
+        while(!solved && pass < GENERATE_MAX_PASSES){
+                ++pass;
+                int repaired = solver_solve(solver, board, job->x, job->y, &rng);
+                perturbations += solver->perturbations;
+                if(!repaired) break;
+                solved = solver->perturbations == 0 || solver_solve(solver, board, job->x, job->y, NULL);
+        }
+        job->solved[slot] = solved;
+        job->passes[slot] = pass;
+        job->perturbations[slot] = perturbations;
+}
+
+int generate_no_guess(Board * board, int x, int y, int thread_count, double seconds, Generate_Stats * stats){
+        double start = profile_now();
+        int slot_count = thread_count < 1 ? 1 : thread_count;
+        Generate_Job job = {
+                .x = x,
+                .y = y,
+                .seed = rng_next(&board->rng),
+                .deadline = start + seconds,
+                .slots = malloc(sizeof(Board) * slot_count),
+                .solvers = malloc(sizeof(Solver) * slot_count),
+                .solved = malloc(sizeof(int) * slot_count),
+                .passes = malloc(sizeof(int) * slot_count),
+                .perturbations = malloc(sizeof(uint64_t) * slot_count),
+        };
+        if(!job.slots || !job.solvers || !job.solved || !job.passes || !job.perturbations) crash("out of memory for generating");
+        for(int slot = 0; slot < slot_count; ++slot){
+                board_create(&job.slots[slot], board->grid_width, board->grid_height, board->total_mines, 0);
+                solver_create(&job.solvers[slot], board->grid_width, board->grid_height);
+        }
+
+        int winner = -1;
+        while(winner < 0 && profile_now() < job.deadline){
+                parallel_for(slot_count, slot_count, run_attempt, &job);
+                for(int slot = 0; slot < slot_count && winner < 0; ++slot) if(job.solved[slot]) winner = slot;
+                if(winner < 0) job.first_attempt += slot_count;
+        }
+
+        if(winner >= 0){
+                Board const * won = &job.slots[winner];
+                int tile_count = board->grid_width * board->grid_height;
+                memcpy(board->tiles, won->tiles, sizeof(Tile) * tile_count);
+                memcpy(board->mine_counts, won->mine_counts, tile_count);
+                board->hidden_safe_tiles = won->hidden_safe_tiles;
+                board->unflagged_mines = won->unflagged_mines;
+                board->flagged_mines = 0;
+                board->wrong_flags = 0;
+                board->filling = 0;
+                board->fill_head = board->fill_tail = 0;
+                board_touch_rows(board, 0, board->grid_height);
+        }
+        if(stats){
+                *stats = (Generate_Stats){
+                        .attempts = job.first_attempt + (winner < 0 ? 0 : winner + 1),
+                        .passes = winner < 0 ? 0 : job.passes[winner],
+                        .perturbations = winner < 0 ? 0 : job.perturbations[winner],
+                        .seconds = profile_now() - start,
+                };
+        }
+
+        for(int slot = 0; slot < slot_count; ++slot){
+                board_destroy(&job.slots[slot]);
+                solver_destroy(&job.solvers[slot]);
+        }
+        free(job.slots);
+        free(job.solvers);
+        free(job.solved);
+        free(job.passes);
+        free(job.perturbations);
+        return winner >= 0;
+}
@@ -0,0 +1,27 @@
+#ifndef SWEEP_GENERATE_H
+#define SWEEP_GENERATE_H
+
+#include <stdint.h>
+#include "board.h"
+
+//No guess boards: plants, solves from the first click with solver.h, and where the solver gets stuck
+//moves mines until it doesn't, then checks the result with a clean solve. Attempts run a round at a
+//time across the worker threads, each from its own seed, and the lowest attempt that worked wins so
+//the board only depends on the seed, not on the thread count, unless the time runs out.
+
+//how many repair and check rounds one attempt gets before it's thrown away.
+#define GENERATE_MAX_PASSES 4
+
+typedef struct{
+        int attempts;
+        //the winning attempt's repair rounds and how often it moved mines, no moves means planting alone gave a no guess board.
+        int passes;
+        uint64_t perturbations;
+        double seconds;
+} Generate_Stats;
+
+//plants board with x, y and its neighbors safe so it can be finished from there without guessing, giving up
+//after seconds. returns 0 and leaves the board as it was if no attempt made it in time. stats can be NULL.
+int generate_no_guess(Board * board, int x, int y, int thread_count, double seconds, Generate_Stats * stats);
+
+#endif
@@ -0,0 +1,124 @@
+#include <string.h>
+#include "input.h"
+#include "common.h"
+
+static char const input_log_magic[8] = {'s', 'w', 'e', 'e', 'p', 'l', 'o', 'g'};
+
+int input_log_create(Input_Log * log, char const * path, int grid_width, int grid_height, double mine_density, uint64_t seed, int screen_width, int screen_height){
+        *log = (Input_Log){0};
+        log->file = fopen(path, "wb");
+        if(!log->file){
+                perror(path);
+                return 0;
+        }
+        log->writing = 1;
+        memcpy(log->header.magic, input_log_magic, sizeof(log->header.magic));
+        log->header.version = INPUT_LOG_VERSION;
+        log->header.record_size = sizeof(Input_Record);
+        log->header.grid_width = grid_width;
+        log->header.grid_height = grid_height;
+        log->header.screen_width = screen_width;
+        log->header.screen_height = screen_height;
+        log->header.mine_density = mine_density;
+        log->header.seed = seed;
+        if(fwrite(&log->header, sizeof(log->header), 1, log->file) != 1){
+                perror(path);
+                fclose(log->file);
+                return 0;
+        }
+        return 1;
+}
+
+int input_log_open(Input_Log * log, char const * path){
+        *log = (Input_Log){0};
+        log->file = fopen(path, "rb");
+        if(!log->file){
+                perror(path);
+                return 0;
+        }
+        if(fread(&log->header, sizeof(log->header), 1, log->file) != 1
+                        || memcmp(log->header.magic, input_log_magic, sizeof(input_log_magic))
+                        || log->header.version != INPUT_LOG_VERSION
+                        || log->header.record_size != sizeof(Input_Record)
+                        || log->header.grid_width < 1 || log->header.grid_height < 1){
+                fprintf(stderr, "%s isn't an input log this build can read\n", path);
+                fclose(log->file);
+                return 0;
+        }
+        log->has_next = fread(&log->next, sizeof(log->next), 1, log->file) == 1;
+        return 1;
+}
+
+static Input_Record make_record(Input const * input){
+        Input_Record record = {
+                .frame = input->frame,
+                .held = input->held,
+                .cursor_x = input->cursor_x,
+                .cursor_y = input->cursor_y,
+                .scroll = input->scroll,
+                .fill_tiles = input->fill_tiles,
+                .screen_width = input->screen_width,
+                .screen_height = input->screen_height,
+                .steps = input->steps,
+        };
+        return record;
+}
+
+//what a frame without a record carries over from the one before.
+static Input_Record carry_over(Input_Record last, uint64_t frame){
+        last.frame = frame;
+        last.scroll = 0;
+        last.fill_tiles = 0;
+        return last;
+}
+
+static void write_record(Input_Log * log, Input_Record const * record){
+        if(fwrite(record, sizeof(*record), 1, log->file) != 1) crash("couldn't write the input log");
+        log->last = *record;
+        ++log->records;
+}
+
+void input_log_write(Input_Log * log, Input const * input){
+        Input_Record record = make_record(input);
+        Input_Record carried = carry_over(log->last, input->frame);
+        if(log->records == 0 || memcmp(&record, &carried, sizeof(record))) write_record(log, &record);
+        log->frame = input->frame;
+}
+
+int input_log_read(Input_Log * log, Input * input){
+        if(!log->has_next) return 0;
+        Input_Record record = carry_over(log->last, log->frame);
+        if(log->next.frame == log->frame){
+                record = log->next;
+                ++log->records;
+                log->has_next = fread(&log->next, sizeof(log->next), 1, log->file) == 1;
+                if(log->has_next && log->next.frame <= record.frame) crash("the input log's frames go backwards");
+        }else if(log->next.frame < log->frame) crash("the input log's frames go backwards");
+
+        *input = (Input){
+                .frame = log->frame,
+                .screen_width = record.screen_width,
+                .screen_height = record.screen_height,
+                .cursor_x = record.cursor_x,
+                .cursor_y = record.cursor_y,
+                .scroll = record.scroll,
+                .held = record.held,
+                .pressed = record.held & ~log->last.held,
+                .fill_tiles = record.fill_tiles,
+                .steps = record.steps,
+        };
+        log->last = record;
+        ++log->frame;
+        return 1;
+}
+
+void input_log_close(Input_Log * log){
+        if(!log->file) return;
+        //the last frame may have matched the one before, it still needs a record to mark the end.
+        if(log->writing && (log->records == 0 || log->last.frame != log->frame)){
+                Input_Record end = carry_over(log->last, log->frame);
+                write_record(log, &end);
+        }
+        fclose(log->file);
+        log->file = NULL;
+}
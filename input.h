@@ -0,0 +1,109 @@
+#ifndef SWEEP_INPUT_H
+#define SWEEP_INPUT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+//What the game reads each frame. It's sampled from glfw or played back from a log, so a recorded
+//session replays frame for frame, with a window or without one.
+
+//bits of Input.held.
+typedef enum{
+        input_sweep,
+        input_flag,
+        input_pan,
+        input_restart,
+        input_instant,
+        input_mode,
+        input_save,
+        input_load,
+        input_left,
+        input_right,
+        input_up,
+        input_down,
+        input_overlay,
+        input_dump,
+        input_no_guess,
+        input_shrink,
+        input_grow,
+        input_easier,
+        input_harder,
+        input_count
+} Input_Button;
+
+typedef struct{
+        uint64_t frame;
+        int screen_width, screen_height;
+        //window pixels with y going up.
+        float cursor_x, cursor_y;
+        //wheel clicks since the last frame.
+        float scroll;
+        uint32_t held;
+        //held this frame and not the one before.
+        uint32_t pressed;
+        //how many tiles the instant flood fill gets through this frame. -1 live, where the fill runs
+        //for a time budget and writes back what it did so the log can replay exactly that much.
+        int fill_tiles;
+        //how many fixed board steps run this frame. -1 live, where the game works it out from the time
+        //since the last frame and writes it back the same way.
+        int steps;
+} Input;
+
+static inline int input_held(Input const * input, Input_Button button){
+        return input->held >> button & 1;
+}
+
+static inline int input_pressed(Input const * input, Input_Button button){
+        return input->pressed >> button & 1;
+}
+
+//the log is a header then a record for every frame whose input differs from the frame before,
+//leaving out scroll and fill_tiles when they're 0. the last frame always gets one so the length is known.
+#define INPUT_LOG_VERSION 2
+
+typedef struct{
+        char magic[8];
+        uint32_t version;
+        uint32_t record_size;
+        int32_t grid_width, grid_height;
+        //the window the game started in, the camera starts framed for it.
+        int32_t screen_width, screen_height;
+        double mine_density;
+        uint64_t seed;
+} Input_Log_Header;
+
+typedef struct{
+        uint32_t frame;
+        uint32_t held;
+        float cursor_x, cursor_y;
+        float scroll;
+        int32_t fill_tiles;
+        uint16_t screen_width, screen_height;
+        int32_t steps;
+} Input_Record;
+
+typedef struct{
+        FILE * file;
+        int writing;
+        Input_Log_Header header;
+        //the frame before's input, which is what a frame without a record gets bar scroll and fill_tiles.
+        Input_Record last;
+        //writing, the last frame written. reading, the next frame to hand out.
+        uint64_t frame;
+        //reading, the next record in the file and whether there is one.
+        Input_Record next;
+        int has_next;
+        uint64_t records;
+} Input_Log;
+
+//returns 0 and says why on stderr if the file can't be opened or isn't a log.
+int input_log_create(Input_Log * log, char const * path, int grid_width, int grid_height, double mine_density, uint64_t seed, int screen_width, int screen_height);
+int input_log_open(Input_Log * log, char const * path);
+//call once per frame with the frame's input after the game has filled in fill_tiles.
+void input_log_write(Input_Log * log, Input const * input);
+//the next frame's input, returns 0 after the last frame.
+int input_log_read(Input_Log * log, Input * input);
+//writes the closing record when recording.
+void input_log_close(Input_Log * log);
+
+#endif
@@ -3,99 +3,211 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <GLES3/gl3.h>
-#if defined(EMSCRIPTEN)
+#if defined(__EMSCRIPTEN__)
 #include <emscripten.h>
 #endif
+#include "common.h"
+#include "board.h"
+#include "game.h"
+#include "input.h"
+#include "profile.h"
 
 typedef struct{
         float x, y, z;
 } Vertex;
 
-typedef struct{
-        float x, y; 
-} Vec2;
-
 typedef struct{
         float u, v;
 } UV;
 
+//per tile data for the instanced draw, only the tiles in view are sent.
+typedef struct{
+        uint8_t r, g, b, a;
+} Color;
+
+//columns and rows, the ends are one past the last.
+typedef struct{
+        int first_column, first_row;
+        int end_column, end_row;
+} Tile_Range;
+
+//M switches between them so both can be timed on the same board.
+typedef enum{
+        //a hexagon mesh per tile, colors built on the cpu every frame.
+        render_instanced,
+        //one quad over the board, the fragment shader finds the tile and reads its state from a texture.
+        render_sdf,
+        render_mode_count
+} Render_Mode;
+
+c_str render_mode_names[] = {"instanced", "sdf"};
+
 #define DEFINE_SLICE(Type) typedef struct { uint64_t size; Type * data;} Type##_Slice;
 
 DEFINE_SLICE(Vertex)
 
 Vertex hex_grid_line_buffer[1<<10];
 
-typedef enum{
-        none = 0,
-        hidden = 1 << 0,
-        charged = 1 << 1,
-        flagged = 1 << 3,
-} Tile;
-
+//gpu objects that only need to change when the board geometry does.
+typedef struct{
+        GLuint hexagon_object;
+        GLuint hex_grid_object;
+        GLuint hexagon_index_object;
+        GLuint tile_offset_object;
+        GLuint tile_color_object;
+        Vec2 * tile_offsets;
+        Color * tile_colors;
+        int tile_capacity;
+
+        //for render_sdf, the tile and its mine count as two bytes per texel.
+        GLuint board_quad_object;
+        GLuint tile_texture;
+        uint8_t * tile_texels;
+        int texel_capacity;
+        //board->row_changes as of each row's last upload, rows only go up while they're in view.
+        uint64_t * texture_row_changes;
+
+        //a byte per tile in glyph_range, its index into tile_glyphs plus one, drawn as instances by the glyph pass.
+        GLuint glyph_object;
+        uint8_t * glyphs;
+        int glyph_capacity;
+        Tile_Range glyph_range;
+        //board->changes when the glyphs were last packed, rows changed after that get packed again.
+        uint64_t glyph_changes;
+#if defined(SWEEP_PROFILE)
+        GLuint profile_overlay_object;
+#endif
 
-static int test_flags(int flags, int bits){
-        return (flags & bits) == bits;
-}
+        //what the buffers were built for.
+        float hexagon_diameter;
+        int grid_width, grid_height;
+        int screen_width, screen_height;
+} Render_Resources;
 
 typedef struct{
         GLFWwindow * window;
         GLuint program;
         GLint ubo_location;
-        GLint ubo_color_location;
+        GLint zoom_location;
+
+        GLuint sdf_program;
+        GLint sdf_offset_location;
+        GLint sdf_zoom_location;
+        GLint sdf_diameter_location;
+        GLint sdf_hover_location;
+        GLint sdf_search_location;
+        GLint sdf_won_location;
+
+        //mine counts, flags and mines for every tile in view in one instanced draw, in either render mode.
+        GLuint glyph_program;
+        GLint glyph_offset_location;
+        GLint glyph_zoom_location;
+        GLint glyph_diameter_location;
+        GLint glyph_first_tile_location;
+        GLint glyph_columns_location;
+        //made once, they don't depend on the board.
+        GLuint glyph_atlas;
+        GLuint glyph_quad_object;
+        Render_Mode render_mode;
+        Render_Resources render;
 
         uint64_t frame;
+        int draw_calls;
+        int last_draw_calls;
 
         float line_width;
 
         Vertex hexagon_tile[7];
-        float hexagon_diameter;
-        int grid_width, grid_height;
         Vertex_Slice tile_points;
         Vertex_Slice hex_grid_lines;
 
-        //sizeof width * height;
-        Tile * tiles;
-        uint8_t * mine_counts;
+        Game game;
+        //updates run so far, drawn or not, input is stamped with it.
+        uint64_t updates;
+        //from the command line, see read_arguments.
+        int start_width, start_height;
+        double mine_density;
+        uint64_t seed;
+        char const * record_path;
+        char const * replay_path;
 
         //Live state
-        int screen_width, screen_height;
-        int total_mines;
-        int won;
-        enum {
-                not_exploding,
-                exploding,
-                re_planting
-        } failing;
-        int exploding_mine_index;
-        int clearing_row_index;
-        int filling;
-        int * tiles_to_search;
-        int depth;
-        int max_depth;
-
-        int flag_button_was_released;
-        int sweep_button_was_released;
+        //this frame's input, the one before is kept for the key edges.
+        Input input;
+        //scroll wheel clicks since the last update.
+        double scroll;
+        Input_Log record_log;
+        Input_Log replay_log;
+        double replay_start;
+
+        //render on demand, a frame is only drawn when something on screen changed.
+        uint64_t drawn_changes;
+        int drawn_hover_x, drawn_hover_y;
+        Camera drawn_camera;
+        int redraw;
+        int skipped_late;
+#if defined(__EMSCRIPTEN__)
+        int fast_main_loop;
+#endif
+
+#if defined(SWEEP_PROFILE)
+        Profiler profiler;
+        int show_profile;
+        double cpu_sample_time, cpu_sample_seconds;
+        double cpu_percent;
+#endif
 }State;
 
 State state_d;
 
-typedef  char const * c_str;
-
-static void crash(c_str message){
-        fputs(message, stderr);
-        abort();
-}
+//counts the gl calls made each frame when profiling.
+#define GL(call) (PROFILE_COUNT(&state->profiler, counter_gl_calls, 1), call)
 
+//pixels index a width by height grid of hexagons laid out like the board, row 0 on top and odd rows half a pixel right.
 typedef struct{
         int width, height, pixel_count, * pixels;
+        //baked into the atlas so the glyph pass doesn't need per glyph uniforms.
+        Color color;
 } hex_glyph;
 
-#define ARRAY_SIZE(array) sizeof(array)/sizeof(array[0])
-
 int a_glyph_pixels[] = {2, 3, 7, 9, 13, 15, 16, 18, 25, 28, 31, 33, 38, 39,};
 hex_glyph a_glyph = {.width = 6, .height = 7, .pixel_count = ARRAY_SIZE(a_glyph_pixels), .pixels = a_glyph_pixels};
 
+int one_glyph_pixels[] = {2, 3, 7, 8, 14, 15, 20, 26, 27, 32, 37, 38, 39, 40};
+int two_glyph_pixels[] = {1, 2, 3, 6, 9, 16, 20, 25, 30, 36, 37, 38, 39, 40};
+int three_glyph_pixels[] = {1, 2, 3, 6, 9, 16, 20, 21, 28, 30, 33, 37, 38, 39};
+int four_glyph_pixels[] = {4, 8, 9, 13, 16, 18, 21, 24, 25, 26, 27, 28, 33, 40};
+int five_glyph_pixels[] = {0, 1, 2, 3, 4, 6, 12, 13, 14, 15, 21, 28, 30, 33, 37, 38, 39};
+int six_glyph_pixels[] = {1, 2, 3, 6, 12, 13, 14, 15, 18, 21, 24, 28, 30, 33, 37, 38, 39};
+int flag_glyph_pixels[] = {1, 2, 3, 4, 7, 8, 9, 13, 14, 19, 25, 30, 31, 36, 37, 38, 39};
+int mine_glyph_pixels[] = {2, 3, 7, 8, 9, 13, 14, 15, 16, 18, 19, 20, 21, 22, 25, 26, 27, 28, 31, 32, 33, 38, 39};
+
+#define GLYPH(name, r, g, b) {.width = 6, .height = 7, .pixel_count = ARRAY_SIZE(name##_glyph_pixels), .pixels = name##_glyph_pixels, .color = {r, g, b, UINT8_MAX}}
+
+//the atlas in order, a tile's glyph is its index here plus one so 0 can mean no glyph.
+hex_glyph tile_glyphs[] = {
+        GLYPH(one, 150, 200, 255),
+        GLYPH(two, 150, 255, 150),
+        GLYPH(three, 255, 255, 120),
+        GLYPH(four, 255, 180, 80),
+        GLYPH(five, 255, 120, 255),
+        GLYPH(six, 150, 255, 255),
+        GLYPH(flag, 255, 80, 50),
+        GLYPH(mine, 0, 0, 0),
+};
+
+typedef enum{
+        glyph_none = 0,
+        //1 to 6 are the mine counts.
+        glyph_flag = 7,
+        glyph_mine = 8,
+} Glyph;
+
+//texels a side of each glyph's square in the atlas.
+#define GLYPH_TEXELS 32
+
 static GLuint load_shader(GLenum type, GLchar const * shader_src){
         puts("loading shader");
         GLuint shader = glCreateShader(type);
@@ -110,14 +222,43 @@ static GLuint load_shader(GLenum type, GLchar const * shader_src){
                 GLint infolen = 0;
                 glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infolen);
                 if(infolen > 1){
-                        char * infolog = malloc(infolen);
-                        glGetShaderInfoLog(shader, infolen, NULL, infolog);
+                        //on the stack so failing doesn't allocate, long logs get cut off.
+                        char infolog[4096];
+                        glGetShaderInfoLog(shader, sizeof(infolog), NULL, infolog);
                         crash(infolog);
                 }
         }
         return shader;
 }
 
+//both programs share attribute locations so the vertex setup doesn't depend on which one is bound.
+static GLuint load_program(GLchar const * vertex_src, GLchar const * fragment_src){
+        GLuint vert = load_shader(GL_VERTEX_SHADER, vertex_src);
+        GLuint frag = load_shader(GL_FRAGMENT_SHADER, fragment_src);
+        GLuint program = glCreateProgram();
+        if(!program) crash("failed to create program object");
+        glAttachShader(program, vert);
+        glAttachShader(program, frag);
+        glBindAttribLocation(program, 0, "vPosition");
+        glBindAttribLocation(program, 1, "instance_offset");
+        glBindAttribLocation(program, 2, "instance_color");
+        glBindAttribLocation(program, 3, "instance_glyph");
+        glLinkProgram(program);
+        GLint linked;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+        if(!linked){
+                GLint infolen = 0;
+                glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infolen);
+                if(infolen > 1){
+                        char infolog[4096];
+                        glGetProgramInfoLog(program, sizeof(infolog), NULL, infolog);
+                        crash(infolog);
+                }
+        }
+        return program;
+}
+
 GLuint hexagon_indices[] = {
         0,1,2,
         2,3,0,
@@ -146,6 +287,306 @@ static void generate_hexagon(Vertex vertices[7], float width){
         }
 }
 
+static Vec2 calculate_hexagon_offset(float hexagon_diameter, int x, int y){
+        Vec2 offset = {0};
+        double hex_width = hexagon_diameter * 0.866025404;
+        double origin_offset = hex_width/2;
+        if(y & 1) offset.x = (x * hexagon_diameter + hexagon_diameter/2) * 0.866025404 + origin_offset;
+        else offset.x = x * hex_width + origin_offset;
+        offset.y = y * hexagon_diameter * .75 + hexagon_diameter/2;
+        return offset;
+}
+
+//every tile that overlaps the window, clamped to the board.
+static Tile_Range visible_tiles(Game const * game){
+        Board const * board = &game->board;
+        Vec2 low = screen_to_board(game->camera, game->screen_width, game->screen_height, 0, 0);
+        Vec2 high = screen_to_board(game->camera, game->screen_width, game->screen_height, game->screen_width, game->screen_height);
+        double hex_width = game->hexagon_diameter * 0.866025404;
+        double row_height = game->hexagon_diameter * .75;
+
+        //a tile reaches half a width either side of its center and odd rows sit half a width right.
+        Tile_Range range = {
+                .first_column = floor(low.x / hex_width - 1),
+                .first_row = floor((low.y - game->hexagon_diameter) / row_height),
+                .end_column = floor(high.x / hex_width) + 1,
+                .end_row = floor(high.y / row_height) + 1,
+        };
+        if(range.first_column < 0) range.first_column = 0;
+        if(range.first_row < 0) range.first_row = 0;
+        if(range.end_column > board->grid_width) range.end_column = board->grid_width;
+        if(range.end_row > board->grid_height) range.end_row = board->grid_height;
+        if(range.end_column < range.first_column) range.end_column = range.first_column;
+        if(range.end_row < range.first_row) range.end_row = range.first_row;
+        return range;
+}
+
+//the tile flags in red and the mine count in green, the colors are worked out in the sdf shader.
+static void pack_tile_row(Board const * board, uint8_t * texels, int y){
+        int row = y * board->grid_width;
+        for(int x = 0; x < board->grid_width; ++x){
+                texels[x * 2] = board->tiles[row + x];
+                texels[x * 2 + 1] = board->mine_counts[row + x];
+        }
+}
+
+//re-uploads the rows in view that changed since their last upload, neighboring rows go up in one call.
+//returns how many tiles it sent.
+static int upload_tile_rows(State * state, Tile_Range visible){
+        Board const * board = &state->game.board;
+        Render_Resources * render = &state->render;
+        int visible_texels = (visible.end_row - visible.first_row) * board->grid_width * 2;
+        if(visible_texels > render->texel_capacity){
+                render->tile_texels = realloc(render->tile_texels, visible_texels);
+                if(!render->tile_texels) crash("out of memory for the tile texture");
+                render->texel_capacity = visible_texels;
+        }
+
+        int uploaded = 0;
+        GL(glBindTexture(GL_TEXTURE_2D, render->tile_texture));
+        GL(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+        for(int y = visible.first_row; y < visible.end_row;){
+                if(board->row_changes[y] == render->texture_row_changes[y]){
+                        ++y;
+                        continue;
+                }
+                int first_row = y;
+                for(; y < visible.end_row && board->row_changes[y] != render->texture_row_changes[y]; ++y){
+                        pack_tile_row(board, render->tile_texels + (y - first_row) * board->grid_width * 2, y);
+                        render->texture_row_changes[y] = board->row_changes[y];
+                }
+                GL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first_row, board->grid_width, y - first_row, GL_RG_INTEGER, GL_UNSIGNED_BYTE, render->tile_texels));
+                uploaded += (y - first_row) * board->grid_width;
+        }
+        return uploaded;
+}
+
+//draws tile_glyphs side by side into one texture, each hexagon pixel as a dot, centered in its GLYPH_TEXELS square.
+//every glyph shares the scale so the digits line up.
+static GLuint build_glyph_atlas(void){
+        int glyph_count = ARRAY_SIZE(tile_glyphs);
+        int atlas_width = glyph_count * GLYPH_TEXELS;
+        static Color texels[GLYPH_TEXELS * ARRAY_SIZE(tile_glyphs) * GLYPH_TEXELS];
+        //hexagon pixels are a unit apart, rows are 0.866 apart and the dots overlap a little so strokes join up.
+        float dot_radius = .58;
+        for(int i = 0; i < glyph_count; ++i){
+                hex_glyph const * glyph = &tile_glyphs[i];
+                float units_per_texel = (float)glyph->height / GLYPH_TEXELS;
+                float low_x = glyph->width, high_x = 0;
+                for(int p = 0; p < glyph->pixel_count; ++p){
+                        int y = glyph->pixels[p] / glyph->width;
+                        float x = glyph->pixels[p] % glyph->width + (y & 1) * .5f;
+                        low_x = fminf(low_x, x);
+                        high_x = fmaxf(high_x, x);
+                }
+                float center_x = (low_x + high_x) / 2;
+                float center_y = (glyph->height - 1) * .866025404f / 2;
+                for(int ty = 0; ty < GLYPH_TEXELS; ++ty) for(int tx = 0; tx < GLYPH_TEXELS; ++tx){
+                        float gx = center_x + (tx + .5f - GLYPH_TEXELS / 2) * units_per_texel;
+                        float gy = center_y + (ty + .5f - GLYPH_TEXELS / 2) * units_per_texel;
+                        for(int p = 0; p < glyph->pixel_count; ++p){
+                                int y = glyph->pixels[p] / glyph->width;
+                                //texture rows go up the screen and glyph rows go down it.
+                                float dx = gx - (glyph->pixels[p] % glyph->width + (y & 1) * .5f);
+                                float dy = gy - (glyph->height - 1 - y) * .866025404f;
+                                if(dx * dx + dy * dy > dot_radius * dot_radius) continue;
+                                texels[ty * atlas_width + i * GLYPH_TEXELS + tx] = glyph->color;
+                                break;
+                        }
+                }
+        }
+
+        GLuint atlas;
+        glGenTextures(1, &atlas);
+        glBindTexture(GL_TEXTURE_2D, atlas);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlas_width, GLYPH_TEXELS, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+        return atlas;
+}
+
+//the mine count once a tile is open, a flag while it's hidden, or the mine if one went off.
+static inline uint8_t tile_glyph(Board const * board, int tile_index){
+        Tile tile = board->tiles[tile_index];
+        if(test_flags(tile, hidden)) return test_flags(tile, flagged) ? glyph_flag : glyph_none;
+        if(test_flags(tile, charged)) return glyph_mine;
+        return board->mine_counts[tile_index];
+}
+
+//packs and sends the glyph rows in view that changed since the last call, neighboring rows go up in one call.
+//when the view moved onto other tiles every row is packed and the buffer is sent whole. returns how many tiles it packed.
+static int update_glyphs(State * state, Tile_Range visible){
+        Board const * board = &state->game.board;
+        Render_Resources * render = &state->render;
+        int columns = visible.end_column - visible.first_column;
+        int tile_count = columns * (visible.end_row - visible.first_row);
+        int moved = memcmp(&visible, &render->glyph_range, sizeof(Tile_Range)) != 0;
+        if(tile_count > render->glyph_capacity){
+                render->glyphs = realloc(render->glyphs, tile_count);
+                if(!render->glyphs) crash("out of memory for the glyphs");
+                render->glyph_capacity = tile_count;
+        }
+
+        int packed = 0;
+        GL(glBindBuffer(GL_ARRAY_BUFFER, render->glyph_object));
+        for(int y = visible.first_row; y < visible.end_row;){
+                if(!moved && board->row_changes[y] <= render->glyph_changes){
+                        ++y;
+                        continue;
+                }
+                int first_row = y;
+                for(; y < visible.end_row && (moved || board->row_changes[y] > render->glyph_changes); ++y){
+                        uint8_t * row = render->glyphs + (y - visible.first_row) * columns;
+                        for(int x = visible.first_column; x < visible.end_column; ++x) row[x - visible.first_column] = tile_glyph(board, board_tile_index(board, x, y));
+                }
+                int offset = (first_row - visible.first_row) * columns;
+                if(!moved) GL(glBufferSubData(GL_ARRAY_BUFFER, offset, (y - first_row) * columns, render->glyphs + offset));
+                packed += (y - first_row) * columns;
+        }
+        if(moved) GL(glBufferData(GL_ARRAY_BUFFER, tile_count, render->glyphs, GL_DYNAMIC_DRAW));
+        render->glyph_range = visible;
+        render->glyph_changes = board->changes;
+        return packed;
+}
+
+static void release_render_resources(Render_Resources * render){
+        GLuint buffers[] = {
+                render->hexagon_object,
+                render->hex_grid_object,
+                render->hexagon_index_object,
+                render->tile_offset_object,
+                render->tile_color_object,
+                render->board_quad_object,
+                render->glyph_object,
+#if defined(SWEEP_PROFILE)
+                render->profile_overlay_object,
+#endif
+        };
+        //zero names are silently ignored.
+        glDeleteBuffers(ARRAY_SIZE(buffers), buffers);
+        glDeleteTextures(1, &render->tile_texture);
+        free(render->tile_offsets);
+        free(render->tile_colors);
+        free(render->tile_texels);
+        free(render->texture_row_changes);
+        free(render->glyphs);
+        *render = (Render_Resources){0};
+}
+
+static void build_render_resources(State * state){
+        Render_Resources * render = &state->render;
+        Game const * game = &state->game;
+        Board const * board = &game->board;
+        release_render_resources(render);
+
+        render->hexagon_diameter = game->hexagon_diameter;
+        render->grid_width = board->grid_width;
+        render->grid_height = board->grid_height;
+        render->screen_width = game->screen_width;
+        render->screen_height = game->screen_height;
+
+        generate_hexagon(state->hexagon_tile, game->hexagon_diameter);
+
+        glGenBuffers(1, &render->hexagon_object);
+        glBindBuffer(GL_ARRAY_BUFFER, render->hexagon_object);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(state->hexagon_tile), state->hexagon_tile, GL_STATIC_DRAW);
+
+        glGenBuffers(1, &render->hex_grid_object);
+        glBindBuffer(GL_ARRAY_BUFFER, render->hex_grid_object);
+        glBufferData(GL_ARRAY_BUFFER, state->hex_grid_lines.size * sizeof(Vertex), state->hex_grid_lines.data, GL_STATIC_DRAW);
+
+        glGenBuffers(1, &render->hexagon_index_object);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, render->hexagon_index_object);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(hexagon_indices), hexagon_indices, GL_STATIC_DRAW);
+
+        //instancing, one hexagon per tile in view, the offsets and colors are refilled every frame that's drawn.
+        glGenBuffers(1, &render->tile_offset_object);
+        glGenBuffers(1, &render->tile_color_object);
+        glGenBuffers(1, &render->glyph_object);
+
+        //the quad only has to cover the board, the shader discards what's between the edge hexagons.
+        Vec2 extent = board_extent(game->hexagon_diameter, board->grid_width, board->grid_height);
+        Vertex board_quad[] = {{0, 0, 0}, {extent.x, 0, 0}, {extent.x, extent.y, 0}, {0, extent.y, 0}};
+        glGenBuffers(1, &render->board_quad_object);
+        glBindBuffer(GL_ARRAY_BUFFER, render->board_quad_object);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(board_quad), board_quad, GL_STATIC_DRAW);
+
+        GLint max_texture_size;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+        if(board->grid_width <= max_texture_size && board->grid_height <= max_texture_size){
+                //every row has been touched at least once, so zeroed stamps upload each row the first time it's seen.
+                render->texture_row_changes = calloc(board->grid_height, sizeof(uint64_t));
+                if(!render->texture_row_changes) crash("out of memory for the tile texture");
+                glGenTextures(1, &render->tile_texture);
+                glBindTexture(GL_TEXTURE_2D, render->tile_texture);
+                //integer textures can't be filtered.
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8UI, board->grid_width, board->grid_height, 0, GL_RG_INTEGER, GL_UNSIGNED_BYTE, NULL);
+        }else printf("a %dx%d board is too big for a tile texture, the sdf renderer is off\n", board->grid_width, board->grid_height);
+
+#if defined(SWEEP_PROFILE)
+        glGenBuffers(1, &render->profile_overlay_object);
+#endif
+}
+
+static int render_resources_stale(State const * state){
+        Render_Resources const * render = &state->render;
+        Game const * game = &state->game;
+        return render->hexagon_diameter != game->hexagon_diameter
+                || render->grid_width != game->board.grid_width
+                || render->grid_height != game->board.grid_height
+                || render->screen_width != game->screen_width
+                || render->screen_height != game->screen_height;
+}
+
+//how long to sleep waiting for input when nothing is animating.
+#define IDLE_WAIT_SECONDS 1.0
+
+static void wake_main_loop(GLFWwindow * window){
+#if defined(__EMSCRIPTEN__)
+        State * state = glfwGetWindowUserPointer(window);
+        if(!state->fast_main_loop){
+                emscripten_set_main_loop_timing(EM_TIMING_RAF, 1);
+                state->fast_main_loop = 1;
+        }
+#else
+        (void)window;
+#endif
+}
+
+static void cursor_moved(GLFWwindow * window, double x, double y){
+        (void)x, (void)y;
+        wake_main_loop(window);
+}
+
+static void mouse_button_changed(GLFWwindow * window, int button, int action, int mods){
+        (void)button, (void)action, (void)mods;
+        wake_main_loop(window);
+}
+
+static void key_changed(GLFWwindow * window, int key, int scancode, int action, int mods){
+        (void)key, (void)scancode, (void)action, (void)mods;
+        wake_main_loop(window);
+}
+
+static void scrolled(GLFWwindow * window, double x, double y){
+        (void)x;
+        State * state = glfwGetWindowUserPointer(window);
+        state->scroll += y;
+        wake_main_loop(window);
+}
+
+static void framebuffer_resized(GLFWwindow * window, int width, int height){
+        (void)width, (void)height;
+        State * state = glfwGetWindowUserPointer(window);
+        state->redraw = 1;
+        wake_main_loop(window);
+}
+
 static void settup(void * state_p){
         State * state = state_p;
         if(!glfwInit()) crash("no glfw.");
@@ -154,21 +595,34 @@ static void settup(void * state_p){
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_ANY_PROFILE);
-        state->screen_width = 650;
-        state->screen_height = 650;
-        state->window = glfwCreateWindow(state->screen_width, state->screen_height, "sweep", NULL, NULL);
+        //a replay gets the window it was recorded in, the log has the size every frame anyway.
+        int window_width = state->replay_path ? state->replay_log.header.screen_width : 650;
+        int window_height = state->replay_path ? state->replay_log.header.screen_height : 650;
+        state->window = glfwCreateWindow(window_width, window_height, "sweep", NULL, NULL);
 
         glfwMakeContextCurrent(state->window);
+        glfwSetWindowUserPointer(state->window, state);
+        glfwSetCursorPosCallback(state->window, cursor_moved);
+        glfwSetMouseButtonCallback(state->window, mouse_button_changed);
+        glfwSetKeyCallback(state->window, key_changed);
+        glfwSetFramebufferSizeCallback(state->window, framebuffer_resized);
+        glfwSetScrollCallback(state->window, scrolled);
+        state->redraw = 1;
+#if defined(__EMSCRIPTEN__)
+        state->fast_main_loop = 1;
+#endif
 
         GLchar vShaderStr[] =  
                 "#version 300 es\n"
                 "in vec4 vPosition;\n"
+                "in vec2 instance_offset;\n"
+                "in vec4 instance_color;\n"
                 "out vec4 frag_color;\n"
                 "uniform vec2 offset;\n"
-                "uniform vec4 color;\n"
+                "uniform float zoom;\n"
                 "void main(){\n"
-                "   gl_Position = vPosition + vec4(offset, 0, 0);\n"
-                "   frag_color = color;\n"
+                "   gl_Position = vec4((vPosition.xy + instance_offset) * zoom + offset, vPosition.zw);\n"
+                "   frag_color = instance_color;\n"
                 "}\n";
         
         GLchar fShaderStr[] =  
@@ -181,360 +635,587 @@ static void settup(void * state_p){
                 "  color = vec4 ( 1.0, 1.0, 1.0, 1.0 ) * frag_color;\n"
                 "}\n";
 
-        GLuint vert = load_shader(GL_VERTEX_SHADER, vShaderStr);
-        GLuint frag = load_shader(GL_FRAGMENT_SHADER, fShaderStr);
-        state->program = glCreateProgram();
-        if(!state->program) crash("failed to create program object");
-        glAttachShader(state->program, vert);
-        glAttachShader(state->program, frag);
-        glBindAttribLocation(state->program, 0, "vPosition");
-        glLinkProgram(state->program);
-        GLint linked;
-        glGetProgramiv(state->program, GL_LINK_STATUS, &linked);
-
-        if(!linked){
-                GLint infolen = 0;
-                glGetProgramiv(state->program, GL_INFO_LOG_LENGTH, &infolen);
-                if(infolen > 1){
-                        char * infolog = malloc(infolen);
-                        glGetShaderInfoLog(state->program, infolen, NULL, infolog);
-                        crash(infolog);
-                }
-        }
-
+        state->program = load_program(vShaderStr, fShaderStr);
         state->ubo_location = glGetUniformLocation(state->program, "offset");
-        if(state->ubo_location < 0) crash("bad");
-
-        state->ubo_color_location = glGetUniformLocation(state->program, "color");
-        if(state->ubo_color_location < 0) crash("bad");
-        
+        state->zoom_location = glGetUniformLocation(state->program, "zoom");
+        if(state->ubo_location < 0 || state->zoom_location < 0) crash("bad");
 
-        glClearColor(.5,0,.5,1);
-
-        // generate_hex_grid_lines(state);
-        state->line_width = 1;
-
-        state->grid_width = 11; 
-        //TODO: calculate height from how many tiles can fit.
-        state->grid_height = 12;
-        state->hexagon_diameter = (2.0-(2.0/(state->grid_width * 0.866025404) * 0.5 ))/(state->grid_width * 0.866025404);
+        //the board in one quad, positions are in the same 0 to 2 space as the tile offsets.
+        GLchar sdf_vertex_src[] =
+                "#version 300 es\n"
+                "in vec4 vPosition;\n"
+                "out vec2 board_position;\n"
+                "uniform vec2 offset;\n"
+                "uniform float zoom;\n"
+                "void main(){\n"
+                "   gl_Position = vec4(vPosition.xy * zoom + offset, vPosition.zw);\n"
+                "   board_position = vPosition.xy;\n"
+                "}\n";
 
+        //finds the tile under the pixel the same way pick_hexagon does, then colors it like the instanced build loop.
+        GLchar sdf_fragment_src[] =
+                "#version 300 es\n"
+                "precision highp float;\n"
+                "precision highp int;\n"
+                "in vec2 board_position;\n"
+                "out vec4 color;\n"
+                "uniform highp usampler2D tiles;\n"
+                "uniform float diameter;\n"
+                "uniform ivec2 hover;\n"
+                "uniform ivec2 search;\n"
+                "uniform bool won;\n"
+                "void main(){\n"
+                "   float radius = diameter * 0.5;\n"
+                "   vec2 p = board_position - vec2(diameter * 0.433012702, radius);\n"
+                "   float q = (p.x * 0.577350269 - p.y / 3.0) / radius;\n"
+                "   float r = (p.y * 2.0 / 3.0) / radius;\n"
+                "   vec3 cube = vec3(q, r, -q - r);\n"
+                "   vec3 rounded = floor(cube + 0.5);\n"
+                "   vec3 error = abs(rounded - cube);\n"
+                "   if(error.x > error.y && error.x > error.z) rounded.x = -rounded.y - rounded.z;\n"
+                "   else if(error.y > error.z) rounded.y = -rounded.x - rounded.z;\n"
+                "   int row = int(rounded.y);\n"
+                "   ivec2 tile = ivec2(int(rounded.x) + (row - (row & 1)) / 2, row);\n"
+                "   ivec2 size = textureSize(tiles, 0);\n"
+                "   if(any(lessThan(tile, ivec2(0))) || any(greaterThanEqual(tile, size))) discard;\n"
+                "   uvec2 texel = texelFetch(tiles, tile, 0).rg;\n"
+                "   float mines = float(texel.g) / 6.0;\n"
+                "   vec3 rgb = vec3(1.0 - float(tile.x) / float(size.x), tile == hover ? 1.0 : 0.0, 1.0 - float(tile.y) / float(size.y));\n"
+                "   if(tile == search) rgb.r = 1.0;\n"
+                "   if((texel.r & 1u) == 0u){\n"
+                "      if((texel.r & 2u) != 0u) rgb = vec3(1.0, 0.0, 0.0);\n"
+                "      else if(won) rgb = vec3(0.2, 0.2 + mines * 0.8, 0.2);\n"
+                "      else rgb = vec3(0.2 + mines * 0.8, 0.2, 0.2);\n"
+                "   }else if((texel.r & 8u) != 0u) rgb = vec3(0.0, 0.5, 0.5);\n"
+                "   color = vec4(rgb, 1.0);\n"
+                "}\n";
 
+        state->sdf_program = load_program(sdf_vertex_src, sdf_fragment_src);
+        state->sdf_offset_location = glGetUniformLocation(state->sdf_program, "offset");
+        state->sdf_zoom_location = glGetUniformLocation(state->sdf_program, "zoom");
+        state->sdf_diameter_location = glGetUniformLocation(state->sdf_program, "diameter");
+        state->sdf_hover_location = glGetUniformLocation(state->sdf_program, "hover");
+        state->sdf_search_location = glGetUniformLocation(state->sdf_program, "search");
+        state->sdf_won_location = glGetUniformLocation(state->sdf_program, "won");
+        if(state->sdf_offset_location < 0 || state->sdf_zoom_location < 0 || state->sdf_diameter_location < 0 || state->sdf_hover_location < 0
+                        || state->sdf_search_location < 0 || state->sdf_won_location < 0) crash("sdf shader is missing a uniform");
+
+        //a unit quad per tile in view, placed on the tile from the instance number the way calculate_hexagon_offset does.
+        //glyphs are 0.6 of a tile across, tiles without one collapse to a point and draw nothing.
+        GLchar glyph_vertex_src[] =
+                "#version 300 es\n"
+                "in vec4 vPosition;\n"
+                "in uint instance_glyph;\n"
+                "out vec2 atlas_position;\n"
+                "uniform vec2 offset;\n"
+                "uniform float zoom;\n"
+                "uniform float diameter;\n"
+                "uniform ivec2 first_tile;\n"
+                "uniform int columns;\n"
+                "void main(){\n"
+                "   ivec2 tile = first_tile + ivec2(gl_InstanceID % columns, gl_InstanceID / columns);\n"
+                "   float hex_width = diameter * 0.866025404;\n"
+                "   vec2 center = vec2((float(tile.x) + float(tile.y & 1) * 0.5 + 0.5) * hex_width, float(tile.y) * diameter * 0.75 + diameter * 0.5);\n"
+                "   float size = instance_glyph == 0u ? 0.0 : diameter * 0.6;\n"
+                "   gl_Position = vec4((center + (vPosition.xy - 0.5) * size) * zoom + offset, 0.0, 1.0);\n"
+                "   atlas_position = vec2(float(instance_glyph) - 1.0 + vPosition.x, vPosition.y);\n"
+                "}\n";
 
-        generate_hexagon(state->hexagon_tile, state->hexagon_diameter);
+        //atlas_position is in glyphs across, the atlas is a row of square glyphs.
+        GLchar glyph_fragment_src[] =
+                "#version 300 es\n"
+                "precision mediump float;\n"
+                "in vec2 atlas_position;\n"
+                "out vec4 color;\n"
+                "uniform sampler2D glyphs;\n"
+                "void main(){\n"
+                "   ivec2 size = textureSize(glyphs, 0);\n"
+                "   vec4 texel = texture(glyphs, vec2(atlas_position.x * float(size.y) / float(size.x), atlas_position.y));\n"
+                "   if(texel.a < 0.5) discard;\n"
+                "   color = vec4(texel.rgb, 1.0);\n"
+                "}\n";
 
+        state->glyph_program = load_program(glyph_vertex_src, glyph_fragment_src);
+        state->glyph_offset_location = glGetUniformLocation(state->glyph_program, "offset");
+        state->glyph_zoom_location = glGetUniformLocation(state->glyph_program, "zoom");
+        state->glyph_diameter_location = glGetUniformLocation(state->glyph_program, "diameter");
+        state->glyph_first_tile_location = glGetUniformLocation(state->glyph_program, "first_tile");
+        state->glyph_columns_location = glGetUniformLocation(state->glyph_program, "columns");
+        if(state->glyph_offset_location < 0 || state->glyph_zoom_location < 0 || state->glyph_diameter_location < 0
+                        || state->glyph_first_tile_location < 0 || state->glyph_columns_location < 0) crash("glyph shader is missing a uniform");
+        state->glyph_atlas = build_glyph_atlas();
+        Vertex glyph_quad[] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}};
+        glGenBuffers(1, &state->glyph_quad_object);
+        glBindBuffer(GL_ARRAY_BUFFER, state->glyph_quad_object);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(glyph_quad), glyph_quad, GL_STATIC_DRAW);
 
-        state->tiles = malloc(sizeof(Tile) * state->grid_width * state->grid_height);
-        state->mine_counts = malloc(state->grid_width * state->grid_height); 
-        for(int i = 0; i < state->grid_width * state->grid_height; ++i) state->tiles[i] = hidden; 
-        for(int i = 0; i < state->grid_width * state->grid_height; ++i) state->mine_counts[i] = 0; 
 
-        srand(42069);
+        glClearColor(.5,0,.5,1);
 
-        state->total_mines = state->grid_height * state->grid_width * 0.2;
+        // generate_hex_grid_lines(state);
+        state->line_width = 1;
 
-        for(int i = 0; i < state->total_mines; ++i){
-                int tile = rand() % (state->grid_width * state->grid_height);
-                state->tiles[tile] |= charged;
+        int screen_width, screen_height;
+        glfwGetWindowSize(state->window, &screen_width, &screen_height);
+        //the camera starts framed for the window, so a replay has to start from the recorded one whatever it got.
+        if(state->replay_path){
+                screen_width = state->replay_log.header.screen_width;
+                screen_height = state->replay_log.header.screen_height;
         }
-
-        state->max_depth = state->grid_width * state->grid_height;
-        state->tiles_to_search = malloc(state->max_depth * sizeof(int));
+        game_create(&state->game, state->start_width, state->start_height, state->mine_density, state->seed, screen_width, screen_height);
+        state->game.snapshots_off = state->record_path || state->replay_path;
+        if(state->record_path && !input_log_create(&state->record_log, state->record_path, state->start_width, state->start_height,
+                                state->mine_density, state->seed, screen_width, screen_height)) crash("couldn't start recording");
+        build_render_resources(state);
 #ifndef NDEBUG
         // state->show_charged = 1;
 #endif
 }
 
-static Vec2 calculate_hexagon_offset(float hexagon_diameter, int x, int y){
-        Vec2 offset = {0};
-        double hex_width = hexagon_diameter * 0.866025404;
-        double origin_offset = hex_width/2;
-        if(y & 1) offset.x = (x * hexagon_diameter + hexagon_diameter/2) * 0.866025404 + origin_offset;
-        else offset.x = x * hex_width + origin_offset;
-        offset.y = y * hexagon_diameter * .75 + hexagon_diameter/2;
-        return offset;
-}
+#if defined(SWEEP_PROFILE)
+#define PROFILE_BUCKETS 34
+//the histogram covers 0 to 34ms a millisecond per bucket, so 60hz and 30hz frames both fit.
+#define PROFILE_BUCKET_MS 1.0
 
-static void update(void * state_p){
-        State * state = state_p;
-        glfwPollEvents();
+static void dump_profile(State const * state){
+        profile_dump_csv(&state->profiler, "sweep_profile.csv");
+        profile_dump_json(&state->profiler, "sweep_profile.json");
+        printf("profile: p50 %.3fms p99 %.3fms, wrote sweep_profile.csv and sweep_profile.json\n",
+                        profile_percentile(&state->profiler, .5), profile_percentile(&state->profiler, .99));
+}
 
-        double x_pos, y_pos;
-        glfwGetCursorPos(state->window, &x_pos, &y_pos);
-        y_pos = state->screen_height - y_pos;
+//F1 shows the overlay, F2 dumps the profile.
+static void profile_keys(State * state){
+        if(input_pressed(&state->input, input_overlay)) state->show_profile = !state->show_profile;
+        if(input_pressed(&state->input, input_dump)) dump_profile(state);
+
+        //cpu use over the last couple of seconds of wall time, drawn or not.
+        double now = profile_now();
+        if(now - state->cpu_sample_time >= 2){
+                double cpu_seconds = profile_cpu_seconds();
+                if(state->cpu_sample_time > 0){
+                        state->cpu_percent = 100 * (cpu_seconds - state->cpu_sample_seconds) / (now - state->cpu_sample_time);
+                        printf("cpu %.1f%% %s\n", state->cpu_percent, state->game.animating ? "animating" : "idle");
+                }
+                state->cpu_sample_time = now;
+                state->cpu_sample_seconds = cpu_seconds;
 
-        for(uint64_t i = 0; i < state->tile_points.size; ++i){
-                //TODO: check radius of point to see if it overlaps with mouse
-                //if two points both have the mouse pick the closest
-                //if mouse right is pressed check tile
-                //if mouse left is pressed plant flag
+                char title[96];
+                snprintf(title, sizeof(title), "sweep p50 %.2fms p99 %.2fms cpu %.1f%%",
+                                profile_percentile(&state->profiler, .5), profile_percentile(&state->profiler, .99), state->cpu_percent);
+                glfwSetWindowTitle(state->window, title);
         }
+}
 
+//frame time histogram in the bottom left corner with lines at p50 and p99, in the board's 0 to 2 space.
+static void draw_profile_overlay(State * state){
+        int buckets[PROFILE_BUCKETS];
+        profile_histogram(&state->profiler, buckets, PROFILE_BUCKETS, PROFILE_BUCKET_MS);
+        int most = 1;
+        for(int i = 0; i < PROFILE_BUCKETS; ++i) if(buckets[i] > most) most = buckets[i];
+
+        float left = .05, bottom = .05, width = .8, height = .3;
+        float bar_width = width / PROFILE_BUCKETS;
+        Vertex vertices[PROFILE_BUCKETS * 6 + 4];
+        int count = 0;
+        for(int i = 0; i < PROFILE_BUCKETS; ++i){
+                float x0 = left + i * bar_width, x1 = x0 + bar_width * .8f;
+                float y1 = bottom + height * buckets[i] / most;
+                vertices[count++] = (Vertex){x0, bottom, 0};
+                vertices[count++] = (Vertex){x1, bottom, 0};
+                vertices[count++] = (Vertex){x1, y1, 0};
+                vertices[count++] = (Vertex){x1, y1, 0};
+                vertices[count++] = (Vertex){x0, y1, 0};
+                vertices[count++] = (Vertex){x0, bottom, 0};
+        }
+        double percentiles[2] = {profile_percentile(&state->profiler, .5), profile_percentile(&state->profiler, .99)};
+        for(int i = 0; i < 2; ++i){
+                float x = left + width * percentiles[i] / (PROFILE_BUCKETS * PROFILE_BUCKET_MS);
+                if(x > left + width) x = left + width;
+                vertices[count++] = (Vertex){x, bottom, 0};
+                vertices[count++] = (Vertex){x, bottom + height * 1.1f, 0};
+        }
 
-        //TODO: move this somewhere else. most of this won't change that often.
-        GLuint hexagon_object;
-        glGenBuffers(1, &hexagon_object);
-        glBindBuffer(GL_ARRAY_BUFFER, hexagon_object);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(state->hexagon_tile), state->hexagon_tile, GL_STATIC_DRAW);
-
-        GLuint hex_grid_object;
-        glGenBuffers(1, &hex_grid_object);
-        glBindBuffer(GL_ARRAY_BUFFER, hex_grid_object);
-        glBufferData(GL_ARRAY_BUFFER, state->hex_grid_lines.size * sizeof(Vertex), state->hex_grid_lines.data, GL_STATIC_DRAW);
-
-        GLuint ubo;
-        glGenBuffers(state->ubo_location, &ubo);
+        //the overlay stays put whatever the camera is doing.
+        GL(glUseProgram(state->program));
+        GL(glUniform2f(state->ubo_location, -1, -1));
+        GL(glUniform1f(state->zoom_location, 1));
+        GL(glBindBuffer(GL_ARRAY_BUFFER, state->render.profile_overlay_object));
+        GL(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * count, vertices, GL_STREAM_DRAW));
+        GL(glDisableVertexAttribArray(1));
+        GL(glDisableVertexAttribArray(2));
+        GL(glVertexAttrib2f(1, 0, 0));
+        GL(glVertexAttribPointer(0, sizeof(Vertex)/sizeof(float), GL_FLOAT, 0,0, NULL));
+        GL(glEnableVertexAttribArray(0));
+
+        GL(glVertexAttrib4f(2, .9, .9, .9, 1));
+        GL(glDrawArrays(GL_TRIANGLES, 0, PROFILE_BUCKETS * 6));
+        GL(glVertexAttrib4f(2, 0, 1, 0, 1));
+        GL(glDrawArrays(GL_LINES, PROFILE_BUCKETS * 6, 2));
+        GL(glVertexAttrib4f(2, 1, 0, 0, 1));
+        GL(glDrawArrays(GL_LINES, PROFILE_BUCKETS * 6 + 2, 2));
+        state->draw_calls += 3;
+}
+#endif
 
-        glViewport(0, 0, state->screen_width, state->screen_height);
+//glfw keys behind each Input_Button, the mouse buttons are read separately.
+static int const input_keys[input_count] = {
+        [input_restart] = GLFW_KEY_R,
+        [input_instant] = GLFW_KEY_I,
+        [input_mode] = GLFW_KEY_M,
+        [input_save] = GLFW_KEY_F5,
+        [input_load] = GLFW_KEY_F9,
+        [input_left] = GLFW_KEY_LEFT,
+        [input_right] = GLFW_KEY_RIGHT,
+        [input_up] = GLFW_KEY_UP,
+        [input_down] = GLFW_KEY_DOWN,
+        [input_overlay] = GLFW_KEY_F1,
+        [input_dump] = GLFW_KEY_F2,
+        [input_no_guess] = GLFW_KEY_N,
+        [input_shrink] = GLFW_KEY_LEFT_BRACKET,
+        [input_grow] = GLFW_KEY_RIGHT_BRACKET,
+        [input_easier] = GLFW_KEY_MINUS,
+        [input_harder] = GLFW_KEY_EQUAL,
+};
 
-        glClear(GL_COLOR_BUFFER_BIT);
+static void sample_input(State * state, Input * input){
+        uint32_t held_before = input->held;
+        *input = (Input){.frame = state->updates, .fill_tiles = -1, .steps = -1};
+        glfwGetWindowSize(state->window, &input->screen_width, &input->screen_height);
 
-        glUseProgram(state->program);
+        double x_pos, y_pos;
+        glfwGetCursorPos(state->window, &x_pos, &y_pos);
+        input->cursor_x = x_pos;
+        input->cursor_y = input->screen_height - y_pos;
+        input->scroll = state->scroll;
+        state->scroll = 0;
+
+        input->held |= (uint32_t)(glfwGetMouseButton(state->window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) << input_sweep;
+        input->held |= (uint32_t)(glfwGetMouseButton(state->window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS) << input_flag;
+        input->held |= (uint32_t)(glfwGetMouseButton(state->window, GLFW_MOUSE_BUTTON_MIDDLE) == GLFW_PRESS) << input_pan;
+        for(int button = 0; button < input_count; ++button){
+                if(input_keys[button] && glfwGetKey(state->window, input_keys[button]) == GLFW_PRESS) input->held |= 1u << button;
+        }
+        input->pressed = input->held & ~held_before;
+}
 
-        glBindBuffer(GL_ARRAY_BUFFER, hex_grid_object);
-        glVertexAttribPointer(0, sizeof(Vertex)/sizeof(float), GL_FLOAT, 0,0, NULL);
-        glEnableVertexAttribArray(0);
-        glDrawArrays(GL_LINES, 0, state->hex_grid_lines.size);
+//the log ran out, print what a headless replay would so the two can be compared.
+static void finish_replay(State * state){
+        printf("replayed %llu frames in %.3fs, board hash %016llx\n", (unsigned long long)state->updates,
+                        profile_now() - state->replay_start, (unsigned long long)board_hash(&state->game.board));
+        glfwSetWindowShouldClose(state->window, 1);
+}
 
-        glBindBuffer(GL_ARRAY_BUFFER, hexagon_object);
-        glVertexAttribPointer(0, sizeof(Vertex)/sizeof(float), GL_FLOAT, 0,0, NULL);
-        glEnableVertexAttribArray(0);
-        //TODO: maybe just use a circle radius to draw the tiles, this would make it so we could animate a transition from squares to ngons(maybe a new game mechanic).
-        //      just use the fragment shader and pass it a bunch of points with a radius passed through the ubo.
-        //      this would better match how we detect a click aswell.
-        //      although that would mean we are stuck to 2d until I create an algorithm that can create mesh to mach the ngons.
+static void update(void * state_p){
+        State * state = state_p;
+        Game * game = &state->game;
+        Board * board = &game->board;
 
-        int hoverd_x = -1, hoverd_y = -1;
-        for(int x = 0; x < state->grid_width; ++x){
-                for(int y = 0; y < state->grid_height; ++y){
-                        Vec2 offset = calculate_hexagon_offset(state->hexagon_diameter, x, y);
-
-                        float mouse_distance = sqrt(pow(x_pos - offset.x * state->screen_width * 0.5, 2) + pow(y_pos - offset.y * state->screen_height * 0.5,2));
-                        if(mouse_distance <= (state->hexagon_diameter * 0.5) * state->screen_width * 0.5){
-                                if(hoverd_x > -1 || hoverd_y > -1){
-                                        Vec2 other_offset = calculate_hexagon_offset(state->hexagon_diameter, hoverd_x, hoverd_y);
-                                        float other_mouse_distance = sqrt(pow(x_pos - other_offset.x * state->screen_width * 0.5, 2) + pow(y_pos - other_offset.y * state->screen_height * 0.5,2));
-                                        if(other_mouse_distance > mouse_distance){
-                                                hoverd_x = x;
-                                                hoverd_y = y;
-                                        }
-                                }else{
-                                        hoverd_x = x;
-                                        hoverd_y = y;
-                                }
-                        }
-                }
+#if defined(__EMSCRIPTEN__)
+        glfwPollEvents();
+#else
+        //while animating, frames between board steps have nothing new to draw, so sleep until the next one is due.
+        double step_wait = game->animating ? game_step_wait(game) : IDLE_WAIT_SECONDS;
+        if(state->redraw || state->replay_path || step_wait <= 0) glfwPollEvents();
+        else glfwWaitEventsTimeout(step_wait);
+#endif
+        PROFILE_BEGIN(&state->profiler, phase_input);
+        Input * input = &state->input;
+        if(!state->replay_path) sample_input(state, input);
+        else if(!input_log_read(&state->replay_log, input)){
+                finish_replay(state);
+                return;
         }
+        ++state->updates;
 
-        if(glfwGetKey(state->window, GLFW_KEY_R) == GLFW_PRESS){
-                state->failing = re_planting;
+        if(input_pressed(input, input_mode)){
+                state->render_mode = (state->render_mode + 1) % render_mode_count;
+                state->redraw = 1;
+                printf("render mode: %s\n", render_mode_names[state->render_mode]);
         }
-
-        if(state->failing == exploding){
-                int max_tiles = state->grid_width * state->grid_height;
-                if(state->exploding_mine_index == max_tiles){
-                        state->exploding_mine_index = 0;
-                        state->failing = re_planting;
-                }else for(;state->exploding_mine_index < max_tiles; ++state->exploding_mine_index){
-                        if(test_flags(state->tiles[state->exploding_mine_index], charged)){
-                                state->tiles[state->exploding_mine_index] &= ~hidden;
-                        } else continue;
-                        ++state->exploding_mine_index;
-                        break;
-                }
-        }else if(state->failing == re_planting){
-                if(state->clearing_row_index < state->grid_height){
-                        for(int x = 0; x < state->grid_width; ++x){
-                                state->mine_counts[state->clearing_row_index * state->grid_width + x] = 0;
-                                state->tiles[state->clearing_row_index * state->grid_width + x] = hidden;
-                        }
-                        ++state->clearing_row_index;
-                }else if(state->clearing_row_index == state->grid_height){
-                        for(int i = 0; i < state->total_mines; ++i){
-                                int tile = rand() % (state->grid_width * state->grid_height);
-                                state->tiles[tile] |= charged;
-                        }
-                        state->clearing_row_index = 0;
-                        state->failing = not_exploding;
-                        state->won = 0;
-                }
-
-        }else if(state->filling && state->depth > -1){
-                while(1){
-                        if(state->depth >= state->max_depth) crash("somtin wrong");
-                        
-                        int x = state->tiles_to_search[state->depth] % state->grid_width;
-                        int y = state->tiles_to_search[state->depth] / state->grid_width;
-
-                        int at_max_height = y == state->grid_height-1;
-                        int at_min_height = y==0;
-
-                        int offset_left_x = (x-!(y&1));
-                        int offset_right_x = (x+(y&1));
-                        int left_x = (x-1);
-                        int right_x = (x+1);
-
-                        Tile top_left = none;
-                        Tile top_right = none;
-                        if(!at_max_height){
-                                if(offset_left_x >= 0) top_left = state->tiles[(y+1) * state->grid_width + offset_left_x];
-                                if(offset_right_x < state->grid_width) top_right = state->tiles[(y+1) * state->grid_width + offset_right_x];
-                        }
-
-                        Tile bottom_left = none;
-                        Tile bottom_right = none;
-                        if(!at_min_height){
-                                if(offset_left_x >= 0) bottom_left = state->tiles[(y-1) * state->grid_width + (x-!(y&1))];
-                                if(offset_right_x < state->grid_width) bottom_right = state->tiles[(y-1) * state->grid_width + (x+(y&1))];
-                        }
-
-                        Tile left = none;
-                        Tile right = none;
-                        {
-                                if(left_x >= 0) left = state->tiles[y * state->grid_width + left_x];
-                                if(right_x < state->grid_width) right = state->tiles[y * state->grid_width + right_x];
-
-                        }
-
-                        uint8_t mines_found = 0;
-                        if(top_left != none && (top_left & charged) == charged) ++mines_found;
-                        if(top_right != none && (top_right & charged) == charged) ++mines_found;
-                        if(bottom_left != none && (bottom_left & charged) == charged) ++mines_found;
-                        if(bottom_right != none && (bottom_right & charged) == charged) ++mines_found;
-                        if(left != none && (left & charged) == charged) ++mines_found;
-                        if(right != none && (right & charged) == charged) ++mines_found;
-
-                        state->tiles[state->tiles_to_search[state->depth]] &= ~hidden;
-
-                        if(mines_found > 0){
-                                state->mine_counts[state->tiles_to_search[state->depth]] = mines_found;
-                                if(state->depth == 0){
-                                        state->filling = 0;
-                                        break;
-                                }
-                                else --state->depth;
-                        }else{
-                                if(test_flags(left, hidden) && left_x >= 0){
-                                        state->tiles_to_search[++state->depth] = y * state->grid_width + left_x;
-                                        break;
-                                }else if(test_flags(right, hidden) && right_x < state->grid_width){
-                                        state->tiles_to_search[++state->depth] = y * state->grid_width + right_x;
-                                        break;
-                                }else if(test_flags(top_left, hidden) && !at_max_height && offset_left_x >= 0){
-                                        state->tiles_to_search[++state->depth] = (y+1) * state->grid_width + offset_left_x;
-                                        break;
-                                }else if(test_flags(top_right, hidden) && !at_max_height && offset_right_x < state->grid_width){
-                                        state->tiles_to_search[++state->depth] = (y+1) * state->grid_width + offset_right_x;
-                                        break;
-                                }else if(test_flags(bottom_left, hidden) && !at_min_height && offset_left_x >= 0){
-                                        state->tiles_to_search[++state->depth] = (y-1) * state->grid_width + offset_left_x;
-                                        break;
-                                }else if(test_flags(bottom_right, hidden) && !at_min_height && offset_right_x < state->grid_width){
-                                        state->tiles_to_search[++state->depth] = (y-1) * state->grid_width + offset_right_x;
-                                        break;
-                                }else{
-                                        if(state->depth <= 0){
-                                                state->filling = 0;
-                                                break;
-                                        } else --state->depth;
-                                }
-                        }
-                };
-        }else{
-                state->filling = 0;
-                state->depth = 0;
+        game_input(game, input);
+#if defined(SWEEP_PROFILE)
+        profile_keys(state);
+#endif
+        PROFILE_END(&state->profiler, phase_input);
+
+        PROFILE_BEGIN(&state->profiler, phase_pick);
+        game_pick(game, input);
+        PROFILE_END(&state->profiler, phase_pick);
+
+        PROFILE_BEGIN(&state->profiler, phase_simulate);
+        int hidden_before = board->hidden_safe_tiles;
+        //the simulation has to run whether or not the counters compile in.
+        int touched = game_simulate(game, input);
+        PROFILE_COUNT(&state->profiler, counter_tiles_touched, touched);
+        (void)touched;
+        if(board->hidden_safe_tiles < hidden_before) PROFILE_COUNT(&state->profiler, counter_tiles_revealed, hidden_before - board->hidden_safe_tiles);
+        PROFILE_END(&state->profiler, phase_simulate);
+        if(state->record_path) input_log_write(&state->record_log, input);
+
+        //a frame that couldn't run every step it owed goes undrawn to give the next one the time, never two in a row.
+        if(game->late && !state->skipped_late){
+                state->skipped_late = 1;
+                PROFILE_SKIP(&state->profiler);
+                return;
         }
-
-        state->won = 1;
-        for(Tile * tile = state->tiles; tile != state->tiles + (state->grid_width * state->grid_height); ++tile){
-                if(test_flags(*tile, charged) && !test_flags(*tile, flagged)){
-                        state->won = 0;
-                } else if(test_flags(*tile, hidden) && !test_flags(*tile, charged)){
-                        state->won = 0;
+        state->skipped_late = 0;
+
+        int redraw = state->redraw
+                || board->changes != state->drawn_changes
+                || game->hover_x != state->drawn_hover_x
+                || game->hover_y != state->drawn_hover_y
+                || memcmp(&game->camera, &state->drawn_camera, sizeof(Camera))
+                || render_resources_stale(state);
+#if defined(SWEEP_PROFILE)
+        redraw |= state->show_profile;
+#endif
+        if(!redraw){
+                PROFILE_SKIP(&state->profiler);
+#if defined(__EMSCRIPTEN__)
+                //the browser keeps calling back, so call back rarely until an input callback speeds it up again.
+                if(!game->animating && state->fast_main_loop){
+                        emscripten_set_main_loop_timing(EM_TIMING_SETTIMEOUT, 1000 * IDLE_WAIT_SECONDS);
+                        state->fast_main_loop = 0;
                 }
+#endif
+                return;
+        }
+        state->redraw = 0;
+        state->drawn_changes = board->changes;
+        state->drawn_hover_x = game->hover_x;
+        state->drawn_hover_y = game->hover_y;
+        state->drawn_camera = game->camera;
+
+        PROFILE_BEGIN(&state->profiler, phase_build);
+        if(render_resources_stale(state)) build_render_resources(state);
+        Render_Resources * render = &state->render;
+        int sdf = state->render_mode == render_sdf && render->tile_texture;
+
+        //only what's on screen gets built or uploaded, so the frame costs the same on any size of board.
+        Tile_Range visible = visible_tiles(game);
+        int tile_count = (visible.end_column - visible.first_column) * (visible.end_row - visible.first_row);
+        if(!sdf && tile_count > render->tile_capacity){
+                render->tile_offsets = realloc(render->tile_offsets, sizeof(Vec2) * tile_count);
+                render->tile_colors = realloc(render->tile_colors, sizeof(Color) * tile_count);
+                if(!render->tile_offsets || !render->tile_colors) crash("out of memory for the visible tiles");
+                render->tile_capacity = tile_count;
         }
 
-        //Rendering and input.
-        int sweep_button_pressed = glfwGetMouseButton(state->window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
-        int flag_button_pressed = glfwGetMouseButton(state->window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS;
-
-        //TODO: use glDrawElementsInstaced if I can somehow get that to work on the web.
-        for(int x = 0; x < state->grid_width; ++x){
-                for(int y = 0; y < state->grid_height; ++y){
-                        int tile_index = y * state->grid_width + x;
-                        Tile * tile = &state->tiles[tile_index];
-
-                        Vec2 offset = calculate_hexagon_offset(state->hexagon_diameter, x, y);
-                        glUniform2f(state->ubo_location, offset.x-1, offset.y-1);
+        //the sdf shader colors the tiles itself, so only the rows that changed get packed and sent.
+        if(sdf){
+                int uploaded = upload_tile_rows(state, visible);
+                PROFILE_COUNT(&state->profiler, counter_tiles_touched, uploaded);
+                (void)uploaded;
+        }else for(int y = visible.first_row, instance = 0; y < visible.end_row; ++y){
+                for(int x = visible.first_column; x < visible.end_column; ++x, ++instance){
+                        int tile_index = board_tile_index(board, x, y);
+                        render->tile_offsets[instance] = calculate_hexagon_offset(game->hexagon_diameter, x, y);
 
                         // state->ubo.g = (float)(state->frame & UINT8_MAX)/UINT8_MAX;
-                        float r = 1 - ((float)x/(float)state->grid_width);
-                        float b = 1 - ((float)y/(float)state->grid_height);
+                        float r = 1 - ((float)x/(float)board->grid_width);
+                        float b = 1 - ((float)y/(float)board->grid_height);
                         float g = 0;
-                        if(x == hoverd_x && y == hoverd_y){
-                                if(state->filling){
-                                }else if(state->sweep_button_was_released && sweep_button_pressed){
-                                        state->depth = 0;
-                                        state->tiles_to_search[state->depth] = tile_index;
-                                        if(test_flags(*tile, charged) && !test_flags(*tile, flagged)){
-                                                state->failing = exploding;
-                                                // printf("whatever cell:%d\n", tile);
-                                        }else if(state->tiles[tile_index] == hidden){
-                                                state->tiles_to_search[state->depth] = tile_index;
-                                                state->filling = 1;
-                                        }
-                                }else if (state->flag_button_was_released && flag_button_pressed){
-                                        if(test_flags(*tile, flagged)) *tile &= ~flagged;
-                                        else *tile |= flagged;
-                                } 
-                                g = 1;
-                        }else g = 0;
-
-                        if(state->tiles_to_search[state->depth] == tile_index){
+                        if(x == game->hover_x && y == game->hover_y) g = 1;
+                        else g = 0;
+
+                        if(board_search_tile(board) == tile_index){
                                 r = 1;
                         }
 
-                        if(!test_flags(state->tiles[tile_index], hidden)){
-                                if(test_flags(state->tiles[tile_index], charged)){
+                        if(!test_flags(board->tiles[tile_index], hidden)){
+                                if(test_flags(board->tiles[tile_index], charged)){
                                         r = 1;
                                         g = 0;
                                         b = 0;
                                 }else{
-                                        if(state->won){
+                                        if(board_won(board)){
                                                 r = .2;
-                                                g = .2 + ((float)state->mine_counts[tile_index]/6) * .8 ;
+                                                g = .2 + ((float)board->mine_counts[tile_index]/6) * .8 ;
                                                 b = .2;
                                         }else{
-                                                r = .2 + ((float)state->mine_counts[tile_index]/6) * .8 ;
+                                                r = .2 + ((float)board->mine_counts[tile_index]/6) * .8 ;
                                                 g = .2;
                                                 b = .2;
                                         }
                                 }
-                        }else if(test_flags(state->tiles[tile_index], flagged)){
+                        }else if(test_flags(board->tiles[tile_index], flagged)){
                                 r = .0;
                                 g = .5;
                                 b = .5;
                         }
 
-                        glUniform4f(state->ubo_color_location, r, g, b, 1);
-
-                        glDrawElements(GL_TRIANGLES, 18, GL_UNSIGNED_INT, hexagon_indices);
+                        render->tile_colors[instance] = (Color){r * UINT8_MAX, g * UINT8_MAX, b * UINT8_MAX, UINT8_MAX};
                 }
         }
+        if(!sdf) PROFILE_COUNT(&state->profiler, counter_tiles_touched, tile_count);
+        int glyphs_packed = update_glyphs(state, visible);
+        PROFILE_COUNT(&state->profiler, counter_tiles_touched, glyphs_packed);
+        (void)glyphs_packed;
+        PROFILE_END(&state->profiler, phase_build);
+
+        PROFILE_BEGIN(&state->profiler, phase_submit);
+        int framebuffer_width, framebuffer_height;
+        glfwGetFramebufferSize(state->window, &framebuffer_width, &framebuffer_height);
+        GL(glViewport(0, 0, framebuffer_width, framebuffer_height));
+
+        GL(glClear(GL_COLOR_BUFFER_BIT));
+
+        GL(glUseProgram(state->program));
+        GL(glUniform2f(state->ubo_location, game->camera.offset.x, game->camera.offset.y));
+        GL(glUniform1f(state->zoom_location, game->camera.zoom));
+
+        state->draw_calls = 0;
+
+        //the grid lines are not instanced, so give them a constant offset and color.
+        GL(glDisableVertexAttribArray(1));
+        GL(glDisableVertexAttribArray(2));
+        GL(glVertexAttrib2f(1, 0, 0));
+        GL(glVertexAttrib4f(2, 1, 1, 1, 1));
+        GL(glBindBuffer(GL_ARRAY_BUFFER, render->hex_grid_object));
+        GL(glVertexAttribPointer(0, sizeof(Vertex)/sizeof(float), GL_FLOAT, 0,0, NULL));
+        GL(glEnableVertexAttribArray(0));
+        GL(glDrawArrays(GL_LINES, 0, state->hex_grid_lines.size));
+        ++state->draw_calls;
+
+        //TODO: maybe just use a circle radius to draw the tiles, this would make it so we could animate a transition from squares to ngons(maybe a new game mechanic).
+        //      just use the fragment shader and pass it a bunch of points with a radius passed through the ubo.
+        //      this would better match how we detect a click aswell.
+        //      although that would mean we are stuck to 2d until I create an algorithm that can create mesh to mach the ngons.
+
+        if(sdf){
+                int search = board_search_tile(board);
+                GL(glUseProgram(state->sdf_program));
+                GL(glUniform2f(state->sdf_offset_location, game->camera.offset.x, game->camera.offset.y));
+                GL(glUniform1f(state->sdf_zoom_location, game->camera.zoom));
+                GL(glUniform1f(state->sdf_diameter_location, game->hexagon_diameter));
+                GL(glUniform2i(state->sdf_hover_location, game->hover_x, game->hover_y));
+                GL(glUniform2i(state->sdf_search_location, search < 0 ? -1 : search % board->grid_width, search < 0 ? -1 : search / board->grid_width));
+                GL(glUniform1i(state->sdf_won_location, board_won(board)));
+                GL(glActiveTexture(GL_TEXTURE0));
+                GL(glBindTexture(GL_TEXTURE_2D, render->tile_texture));
+                GL(glBindBuffer(GL_ARRAY_BUFFER, render->board_quad_object));
+                GL(glVertexAttribPointer(0, sizeof(Vertex)/sizeof(float), GL_FLOAT, 0,0, NULL));
+                GL(glDrawArrays(GL_TRIANGLE_FAN, 0, 4));
+                ++state->draw_calls;
+        }else{
+                GL(glBindBuffer(GL_ARRAY_BUFFER, render->tile_color_object));
+                GL(glBufferData(GL_ARRAY_BUFFER, sizeof(Color) * tile_count, render->tile_colors, GL_STREAM_DRAW));
+                GL(glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, NULL));
+                GL(glVertexAttribDivisor(2, 1));
+                GL(glEnableVertexAttribArray(2));
+
+                GL(glBindBuffer(GL_ARRAY_BUFFER, render->tile_offset_object));
+                GL(glBufferData(GL_ARRAY_BUFFER, sizeof(Vec2) * tile_count, render->tile_offsets, GL_STREAM_DRAW));
+                GL(glVertexAttribPointer(1, 2, GL_FLOAT, 0, 0, NULL));
+                GL(glVertexAttribDivisor(1, 1));
+                GL(glEnableVertexAttribArray(1));
+
+                GL(glBindBuffer(GL_ARRAY_BUFFER, render->hexagon_object));
+                GL(glVertexAttribPointer(0, sizeof(Vertex)/sizeof(float), GL_FLOAT, 0,0, NULL));
+                GL(glEnableVertexAttribArray(0));
+
+                GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, render->hexagon_index_object));
+                GL(glDrawElementsInstanced(GL_TRIANGLES, ARRAY_SIZE(hexagon_indices), GL_UNSIGNED_INT, NULL, tile_count));
+                ++state->draw_calls;
+        }
 
-        state->sweep_button_was_released = glfwGetMouseButton(state->window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_RELEASE;
-        state->flag_button_was_released = glfwGetMouseButton(state->window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_RELEASE;
+        //every glyph in view in one call, the instance buffer only changes where rows did.
+        if(tile_count > 0){
+                GL(glUseProgram(state->glyph_program));
+                GL(glUniform2f(state->glyph_offset_location, game->camera.offset.x, game->camera.offset.y));
+                GL(glUniform1f(state->glyph_zoom_location, game->camera.zoom));
+                GL(glUniform1f(state->glyph_diameter_location, game->hexagon_diameter));
+                GL(glUniform2i(state->glyph_first_tile_location, visible.first_column, visible.first_row));
+                GL(glUniform1i(state->glyph_columns_location, visible.end_column - visible.first_column));
+                GL(glActiveTexture(GL_TEXTURE0));
+                GL(glBindTexture(GL_TEXTURE_2D, state->glyph_atlas));
+                GL(glDisableVertexAttribArray(1));
+                GL(glDisableVertexAttribArray(2));
+                GL(glBindBuffer(GL_ARRAY_BUFFER, render->glyph_object));
+                GL(glVertexAttribIPointer(3, 1, GL_UNSIGNED_BYTE, 0, NULL));
+                GL(glVertexAttribDivisor(3, 1));
+                GL(glEnableVertexAttribArray(3));
+                GL(glBindBuffer(GL_ARRAY_BUFFER, state->glyph_quad_object));
+                GL(glVertexAttribPointer(0, sizeof(Vertex)/sizeof(float), GL_FLOAT, 0,0, NULL));
+                GL(glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, tile_count));
+                GL(glDisableVertexAttribArray(3));
+                ++state->draw_calls;
+        }
+
+#if defined(SWEEP_PROFILE)
+        if(state->show_profile) draw_profile_overlay(state);
+#endif
+        PROFILE_COUNT(&state->profiler, counter_draw_calls, state->draw_calls);
+        PROFILE_END(&state->profiler, phase_submit);
 
+        if(state->draw_calls != state->last_draw_calls){
+                printf("draw calls per frame: %d\n", state->draw_calls);
+                state->last_draw_calls = state->draw_calls;
+        }
+
+        PROFILE_BEGIN(&state->profiler, phase_present);
         glfwSwapBuffers(state->window);
+        PROFILE_END(&state->profiler, phase_present);
         ++state->frame;
+        PROFILE_FRAME(&state->profiler);
 }
 
-int main(void){
+static c_str usage = "usage: sweep [--record log | --replay log] [width] [height] [mine density] [seed]\n";
+
+//sweep [width] [height] [mine density] [seed], anything left out keeps the 11x12 board with 20% mines.
+//--record writes every frame's input to a log, --replay plays one back on the board it was recorded on.
+static void read_arguments(State * state, int argc, char ** argv){
+        state->start_width = 11;
+        state->start_height = 12;
+        state->mine_density = .2;
+        state->seed = 42069;
+
+        while(argc > 2 && !strncmp(argv[1], "--", 2)){
+                if(!strcmp(argv[1], "--record")) state->record_path = argv[2];
+                else if(!strcmp(argv[1], "--replay")) state->replay_path = argv[2];
+                else crash(usage);
+                argc -= 2;
+                argv += 2;
+        }
+        if(state->record_path && state->replay_path) crash(usage);
+        if(argc > 5) crash(usage);
+        char * end = "";
+        errno = 0;
+        if(argc > 1) state->start_width = strtol(argv[1], &end, 10);
+        if(argc > 2 && !*end) state->start_height = strtol(argv[2], &end, 10);
+        if(argc > 3 && !*end) state->mine_density = strtod(argv[3], &end);
+        if(argc > 4 && !*end) state->seed = strtoull(argv[4], &end, 0);
+        if(*end || errno || state->start_width < 1 || state->start_height < 1 || !(state->mine_density >= 0 && state->mine_density <= 1)) crash(usage);
+        if((double)state->start_width * state->start_height > INT32_MAX) crash("the board can't have more than 2^31 tiles");
+
+        if(state->replay_path){
+                if(!input_log_open(&state->replay_log, state->replay_path)) crash(usage);
+                Input_Log_Header const * header = &state->replay_log.header;
+                state->start_width = header->grid_width;
+                state->start_height = header->grid_height;
+                state->mine_density = header->mine_density;
+                state->seed = header->seed;
+        }
+}
+
+int main(int argc, char ** argv){
         puts("initalizing");
+        read_arguments(&state_d, argc, argv);
         settup(&state_d);
-#if defined(EMSCRIPTEN)
+        state_d.replay_start = profile_now();
+#if defined(__EMSCRIPTEN__)
         emscripten_set_main_loop_arg(update, &state_d, 0, 0);
 #else
         while(!glfwWindowShouldClose(state_d.window)) update(&state_d);
+        if(state_d.record_path){
+                printf("recorded %llu frames to %s, board hash %016llx\n", (unsigned long long)state_d.updates,
+                                state_d.record_path, (unsigned long long)board_hash(&state_d.game.board));
+        }
+        input_log_close(&state_d.record_log);
+        input_log_close(&state_d.replay_log);
+#if defined(SWEEP_PROFILE)
+        dump_profile(&state_d);
+#endif
 #endif
 }
@@ -0,0 +1,145 @@
+#include "plant.h"
+#include "rng.h"
+#include "thread.h"
+#include "common.h"
+
+//rows per band, sized so a band is about 64k tiles. it only depends on the board so the result doesn't depend on the thread count.
+static int band_rows(int grid_width){
+        int rows = (1 << 16) / grid_width;
+        return rows < 1 ? 1 : rows;
+}
+
+int plant_band_count(int grid_width, int grid_height){
+        int rows = band_rows(grid_width);
+        return (grid_height + rows - 1) / rows;
+}
+
+typedef struct{
+        Board * board;
+        uint64_t seed;
+        int rows;
+        int * band_mines;
+        int const * excluded;
+        int excluded_count;
+} Plant_Job;
+
+//the excluded tiles inside [first, end) as offsets from first, in ascending order.
+static int band_excluded(Plant_Job const * job, int first, int end, int excluded[PLANT_MAX_EXCLUDED]){
+        int count = 0;
+        for(int i = 0; i < job->excluded_count; ++i){
+                int tile = job->excluded[i];
+                if(tile < first || tile >= end) continue;
+                int at = count++;
+                for(; at > 0 && excluded[at-1] > tile - first; --at) excluded[at] = excluded[at-1];
+                excluded[at] = tile - first;
+        }
+        return count;
+}
+
+//maps an index into the band with the excluded tiles taken out to an offset into the band.
+static inline int skip_excluded(int index, int const * excluded, int excluded_count){
+        for(int i = 0; i < excluded_count; ++i) index += index >= excluded[i];
+        return index;
+}
+
+static void plant_band(void * job_p, int band){
+        Plant_Job * job = job_p;
+        Board * board = job->board;
+        int first_row = band * job->rows;
+        int end_row = first_row + job->rows < board->grid_height ? first_row + job->rows : board->grid_height;
+        int first = first_row * board->grid_width;
+        int end = end_row * board->grid_width;
+
+        for(int i = first; i < end; ++i) board->tiles[i] = hidden;
+
+        int excluded[PLANT_MAX_EXCLUDED];
+        int excluded_count = band_excluded(job, first, end, excluded);
+        int space = end - first - excluded_count;
+
+        //Floyd's sampling, the charged bit doubles as the set of picked tiles.
+        uint64_t band_seed = job->seed ^ ((uint64_t)band * 0xd1b54a32d192ed03);
+        Rng rng;
+        rng_seed(&rng, band_seed);
+        Tile * tiles = board->tiles + first;
+        for(int j = space - job->band_mines[band]; j < space; ++j){
+                int tile = skip_excluded(rng_below(&rng, j + 1), excluded, excluded_count);
+                if(test_flags(tiles[tile], charged)) tile = skip_excluded(j, excluded, excluded_count);
+                tiles[tile] |= charged;
+        }
+}
+
+static void count_band(void * job_p, int band){
+        Plant_Job * job = job_p;
+        int first_row = band * job->rows;
+        int end_row = first_row + job->rows < job->board->grid_height ? first_row + job->rows : job->board->grid_height;
+        board_count_mines_rows(job->board, first_row, end_row);
+}
+
+//a fresh plant has no flags and nothing open.
+static void set_counters(Board * board, int64_t mines){
+        board->hidden_safe_tiles = board->grid_width * board->grid_height - mines;
+        board->unflagged_mines = mines;
+        board->flagged_mines = 0;
+        board->wrong_flags = 0;
+        board_touch_rows(board, 0, board->grid_height);
+}
+
+void plant_mines(Board * board, uint64_t seed, int const * excluded, int excluded_count, int thread_count){
+        if(excluded_count > PLANT_MAX_EXCLUDED) crash("too many tiles excluded from planting");
+
+        int rows = band_rows(board->grid_width);
+        int band_count = plant_band_count(board->grid_width, board->grid_height);
+        int * band_mines = board->band_mines;
+        int * band_space = board->band_space;
+
+        Plant_Job job = {
+                .board = board,
+                .seed = seed,
+                .rows = rows,
+                .band_mines = band_mines,
+                .excluded = excluded,
+                .excluded_count = excluded_count,
+        };
+
+        int64_t total_space = 0;
+        for(int band = 0; band < band_count; ++band){
+                int first = band * rows * board->grid_width;
+                int end_row = (band + 1) * rows < board->grid_height ? (band + 1) * rows : board->grid_height;
+                int end = end_row * board->grid_width;
+                int band_excluded_tiles[PLANT_MAX_EXCLUDED];
+                band_space[band] = end - first - band_excluded(&job, first, end, band_excluded_tiles);
+                total_space += band_space[band];
+        }
+
+        int64_t mines = board->total_mines < total_space ? board->total_mines : total_space;
+        int tile_count = board->grid_width * board->grid_height;
+        //nothing to share out, and with every tile excluded there's no space to share it by.
+        if(total_space == 0 || mines == 0){
+                for(int i = 0; i < tile_count; ++i) board->tiles[i] = hidden;
+                for(int i = 0; i < tile_count; ++i) board->mine_counts[i] = 0;
+                set_counters(board, 0);
+                return;
+        }
+
+        //each band gets its share rounded down, the leftovers go one each to consecutive bands from a random one.
+        int64_t given = 0;
+        for(int band = 0; band < band_count; ++band){
+                band_mines[band] = mines * band_space[band] / total_space;
+                given += band_mines[band];
+        }
+        uint64_t split_seed = seed;
+        int band = splitmix64(&split_seed) % band_count;
+        while(given < mines){
+                if(band_mines[band] < band_space[band]){
+                        ++band_mines[band];
+                        ++given;
+                }
+                band = (band + 1) % band_count;
+        }
+
+        parallel_for(band_count, thread_count, plant_band, &job);
+        //counting reads the rows either side of a band, so every band has to be planted first.
+        parallel_for(band_count, thread_count, count_band, &job);
+
+        set_counters(board, mines);
+}
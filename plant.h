@@ -0,0 +1,20 @@
+#ifndef SWEEP_PLANT_H
+#define SWEEP_PLANT_H
+
+#include <stdint.h>
+#include "board.h"
+
+//Mine placement. Exactly the requested number of mines, O(mines) expected work,
+//the same board for the same seed and board size no matter how many threads run it.
+
+//the first click and its six neighbors.
+#define PLANT_MAX_EXCLUDED 7
+
+//how many row bands a board this size plants in, board_memory keeps room for two ints a band.
+int plant_band_count(int grid_width, int grid_height);
+
+//hides every tile and charges total_mines of them, never one of the excluded tile indices,
+//then fills mine_counts. big boards are split into row bands that plant in parallel.
+void plant_mines(Board * board, uint64_t seed, int const * excluded, int excluded_count, int thread_count);
+
+#endif
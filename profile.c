@@ -0,0 +1,153 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <string.h>
+#include "profile.h"
+#include "common.h"
+
+#if defined(__EMSCRIPTEN__)
+#include <emscripten.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+#include <time.h>
+
+char const * const profile_phase_names[phase_count] = {
+        "input",
+        "pick",
+        "simulate",
+        "build",
+        "submit",
+        "present",
+};
+
+char const * const profile_counter_names[counter_count] = {
+        "gl_calls",
+        "draw_calls",
+        "tiles_touched",
+        "tiles_revealed",
+};
+
+double profile_now(void){
+#if defined(__EMSCRIPTEN__)
+        return emscripten_get_now() / 1000.0;
+#elif defined(_WIN32)
+        LARGE_INTEGER frequency, counter;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&counter);
+        return (double)counter.QuadPart / frequency.QuadPart;
+#else
+        struct timespec time;
+        clock_gettime(CLOCK_MONOTONIC, &time);
+        return time.tv_sec + time.tv_nsec / 1e9;
+#endif
+}
+
+void profile_begin(Profiler * profiler, Profile_Phase phase){
+        double now = profile_now();
+        if(profiler->frame_start == 0) profiler->frame_start = now;
+        profiler->phase_start[phase] = now;
+}
+
+void profile_end(Profiler * profiler, Profile_Phase phase){
+        profiler->current.phase_ms[phase] += (profile_now() - profiler->phase_start[phase]) * 1000.0;
+}
+
+void profile_frame(Profiler * profiler){
+        double now = profile_now();
+        if(profiler->frame_start == 0) profiler->frame_start = now;
+        profiler->current.frame = profiler->frame_total;
+        profiler->current.frame_ms = (now - profiler->frame_start) * 1000.0;
+        profiler->frames[profiler->frame_total % PROFILE_FRAMES] = profiler->current;
+        ++profiler->frame_total;
+        profiler->current = (Frame_Profile){0};
+        profiler->frame_start = now;
+}
+
+void profile_skip(Profiler * profiler){
+        profiler->current = (Frame_Profile){0};
+        profiler->frame_start = 0;
+}
+
+double profile_cpu_seconds(void){
+        return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static int frames_kept(Profiler const * profiler){
+        return profiler->frame_total < PROFILE_FRAMES ? profiler->frame_total : PROFILE_FRAMES;
+}
+
+static int compare_doubles(void const * a, void const * b){
+        double difference = *(double const *)a - *(double const *)b;
+        return (difference > 0) - (difference < 0);
+}
+
+double profile_percentile(Profiler const * profiler, double percentile){
+        int count = frames_kept(profiler);
+        if(!count) return 0;
+        double sorted[PROFILE_FRAMES];
+        for(int i = 0; i < count; ++i) sorted[i] = profiler->frames[i].frame_ms;
+        qsort(sorted, count, sizeof(double), compare_doubles);
+        int at = percentile * (count - 1) + .5;
+        return sorted[at];
+}
+
+void profile_histogram(Profiler const * profiler, int * buckets, int bucket_count, double bucket_ms){
+        memset(buckets, 0, sizeof(int) * bucket_count);
+        for(int i = 0; i < frames_kept(profiler); ++i){
+                int bucket = profiler->frames[i].frame_ms / bucket_ms;
+                buckets[bucket < bucket_count ? bucket : bucket_count - 1] += 1;
+        }
+}
+
+//oldest frame first.
+static Frame_Profile const * frame_at(Profiler const * profiler, int i){
+        uint64_t first = profiler->frame_total - frames_kept(profiler);
+        return &profiler->frames[(first + i) % PROFILE_FRAMES];
+}
+
+void profile_dump_csv(Profiler const * profiler, char const * path){
+        FILE * file = fopen(path, "w");
+        if(!file){
+                perror(path);
+                return;
+        }
+        fprintf(file, "frame,frame_ms");
+        for(int phase = 0; phase < phase_count; ++phase) fprintf(file, ",%s_ms", profile_phase_names[phase]);
+        for(int counter = 0; counter < counter_count; ++counter) fprintf(file, ",%s", profile_counter_names[counter]);
+        fprintf(file, "\n");
+        for(int i = 0; i < frames_kept(profiler); ++i){
+                Frame_Profile const * frame = frame_at(profiler, i);
+                fprintf(file, "%llu,%.4f", (unsigned long long)frame->frame, frame->frame_ms);
+                for(int phase = 0; phase < phase_count; ++phase) fprintf(file, ",%.4f", frame->phase_ms[phase]);
+                for(int counter = 0; counter < counter_count; ++counter) fprintf(file, ",%lld", (long long)frame->counters[counter]);
+                fprintf(file, "\n");
+        }
+        fclose(file);
+}
+
+void profile_dump_json(Profiler const * profiler, char const * path){
+        FILE * file = fopen(path, "w");
+        if(!file){
+                perror(path);
+                return;
+        }
+        int count = frames_kept(profiler);
+        double phase_ms[phase_count] = {0};
+        double counters[counter_count] = {0};
+        for(int i = 0; i < count; ++i){
+                Frame_Profile const * frame = frame_at(profiler, i);
+                for(int phase = 0; phase < phase_count; ++phase) phase_ms[phase] += frame->phase_ms[phase];
+                for(int counter = 0; counter < counter_count; ++counter) counters[counter] += frame->counters[counter];
+        }
+        fprintf(file, "{\n  \"frames\": %d,\n  \"p50_ms\": %.4f,\n  \"p99_ms\": %.4f,\n  \"mean_phase_ms\": {",
+                        count, profile_percentile(profiler, .5), profile_percentile(profiler, .99));
+        for(int phase = 0; phase < phase_count; ++phase){
+                fprintf(file, "%s\"%s\": %.4f", phase ? ", " : "", profile_phase_names[phase], count ? phase_ms[phase] / count : 0);
+        }
+        fprintf(file, "},\n  \"mean_counters\": {");
+        for(int counter = 0; counter < counter_count; ++counter){
+                fprintf(file, "%s\"%s\": %.2f", counter ? ", " : "", profile_counter_names[counter], count ? counters[counter] / count : 0);
+        }
+        fprintf(file, "}\n}\n");
+        fclose(file);
+}
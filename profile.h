@@ -0,0 +1,83 @@
+#ifndef SWEEP_PROFILE_H
+#define SWEEP_PROFILE_H
+
+#include <stdint.h>
+
+//Per frame timing scopes and counters, kept for the last PROFILE_FRAMES frames.
+//Only built with -DSWEEP_PROFILE, otherwise the macros compile to nothing.
+
+#define PROFILE_FRAMES 512
+
+typedef enum{
+        phase_input,
+        phase_pick,
+        phase_simulate,
+        phase_build,
+        phase_submit,
+        phase_present,
+        phase_count
+} Profile_Phase;
+
+typedef enum{
+        counter_gl_calls,
+        counter_draw_calls,
+        counter_tiles_touched,
+        counter_tiles_revealed,
+        counter_count
+} Profile_Counter;
+
+typedef struct{
+        uint64_t frame;
+        double frame_ms;
+        double phase_ms[phase_count];
+        int64_t counters[counter_count];
+} Frame_Profile;
+
+typedef struct{
+        Frame_Profile frames[PROFILE_FRAMES];
+        //total frames ended, the newest is frames[(frame_total-1) % PROFILE_FRAMES].
+        uint64_t frame_total;
+        Frame_Profile current;
+        double frame_start;
+        double phase_start[phase_count];
+} Profiler;
+
+//seconds from a monotonic clock, emscripten_get_now on the web.
+double profile_now(void);
+
+void profile_begin(Profiler * profiler, Profile_Phase phase);
+void profile_end(Profiler * profiler, Profile_Phase phase);
+void profile_frame(Profiler * profiler);
+//drops the frame in progress, for frames that end up not drawing anything.
+void profile_skip(Profiler * profiler);
+
+//cpu time used by the whole process, all threads, in seconds.
+double profile_cpu_seconds(void);
+
+//frame time at percentile in [0, 1] over the frames in the ring.
+double profile_percentile(Profiler const * profiler, double percentile);
+//frame times of the ring bucketed into bucket_count buckets of bucket_ms each, the last bucket takes the rest.
+void profile_histogram(Profiler const * profiler, int * buckets, int bucket_count, double bucket_ms);
+
+//every frame in the ring as csv, and a json summary with percentiles and mean phase times.
+void profile_dump_csv(Profiler const * profiler, char const * path);
+void profile_dump_json(Profiler const * profiler, char const * path);
+
+extern char const * const profile_phase_names[phase_count];
+extern char const * const profile_counter_names[counter_count];
+
+#if defined(SWEEP_PROFILE)
+#define PROFILE_BEGIN(profiler, phase) profile_begin((profiler), (phase))
+#define PROFILE_END(profiler, phase) profile_end((profiler), (phase))
+#define PROFILE_COUNT(profiler, counter, amount) ((profiler)->current.counters[(counter)] += (amount))
+#define PROFILE_FRAME(profiler) profile_frame(profiler)
+#define PROFILE_SKIP(profiler) profile_skip(profiler)
+#else
+#define PROFILE_BEGIN(profiler, phase) ((void)0)
+#define PROFILE_END(profiler, phase) ((void)0)
+#define PROFILE_COUNT(profiler, counter, amount) ((void)0)
+#define PROFILE_FRAME(profiler) ((void)0)
+#define PROFILE_SKIP(profiler) ((void)0)
+#endif
+
+#endif
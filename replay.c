@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include "common.h"
+#include "game.h"
+#include "input.h"
+#include "profile.h"
+
+//sweep_replay, plays an input log back with no window as fast as it goes, then prints where the time went
+//and a hash of the board it ended on. sweep --replay prints the same hash after playing the log with the renderer.
+
+static Profiler profiler;
+
+int main(int argc, char ** argv){
+        if(argc != 2) crash("usage: sweep_replay log\n");
+        Input_Log log;
+        if(!input_log_open(&log, argv[1])) return 1;
+        Input_Log_Header const * header = &log.header;
+        Game game;
+        game_create(&game, header->grid_width, header->grid_height, header->mine_density, header->seed, header->screen_width, header->screen_height);
+        game.snapshots_off = 1;
+
+        //only the phases before drawing run headless. the phase timing is what sweep_replay prints, so it calls
+        //profile_begin and profile_end itself instead of the PROFILE_ macros, which are nothing without SWEEP_PROFILE.
+        Profile_Phase const phases[] = {phase_input, phase_pick, phase_simulate};
+        double total_ms[phase_count] = {0};
+        double most_ms[phase_count] = {0};
+        Input input;
+        double start = profile_now();
+        while(input_log_read(&log, &input)){
+                profile_begin(&profiler, phase_input);
+                game_input(&game, &input);
+                profile_end(&profiler, phase_input);
+
+                profile_begin(&profiler, phase_pick);
+                game_pick(&game, &input);
+                profile_end(&profiler, phase_pick);
+
+                profile_begin(&profiler, phase_simulate);
+                game_simulate(&game, &input);
+                profile_end(&profiler, phase_simulate);
+
+                for(uint64_t i = 0; i < ARRAY_SIZE(phases); ++i){
+                        double ms = profiler.current.phase_ms[phases[i]];
+                        total_ms[phases[i]] += ms;
+                        if(ms > most_ms[phases[i]]) most_ms[phases[i]] = ms;
+                }
+                profile_frame(&profiler);
+        }
+        double seconds = profile_now() - start;
+
+        uint64_t frames = log.frame;
+        printf("replayed %llu frames of a %dx%d board in %.3fs, %.3f us per frame, %llu records\n",
+                        (unsigned long long)frames, header->grid_width, header->grid_height, seconds,
+                        frames ? seconds * 1e6 / frames : 0.0, (unsigned long long)log.records);
+        printf("%-10s %12s %12s %12s\n", "phase", "total ms", "mean us", "max us");
+        for(uint64_t i = 0; i < ARRAY_SIZE(phases); ++i){
+                Profile_Phase phase = phases[i];
+                printf("%-10s %12.3f %12.3f %12.3f\n", profile_phase_names[phase], total_ms[phase],
+                                frames ? total_ms[phase] * 1000 / frames : 0.0, most_ms[phase] * 1000);
+        }
+        printf("frame p50 %.3f us p99 %.3f us over the last %d frames\n",
+                        profile_percentile(&profiler, .5) * 1000, profile_percentile(&profiler, .99) * 1000, PROFILE_FRAMES);
+        printf("board hash %016llx\n", (unsigned long long)board_hash(&game.board));
+
+        input_log_close(&log);
+        game_destroy(&game);
+}
@@ -0,0 +1,54 @@
+#ifndef SWEEP_RNG_H
+#define SWEEP_RNG_H
+
+#include <stdint.h>
+
+//xoshiro256** seeded through splitmix64, small enough to give every board and thread its own.
+
+typedef struct{
+        uint64_t s[4];
+} Rng;
+
+static inline uint64_t splitmix64(uint64_t * x){
+        uint64_t z = (*x += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+}
+
+static inline void rng_seed(Rng * rng, uint64_t seed){
+        for(int i = 0; i < 4; ++i) rng->s[i] = splitmix64(&seed);
+}
+
+static inline uint64_t rng_rotl(uint64_t x, int k){
+        return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t rng_next(Rng * rng){
+        uint64_t * s = rng->s;
+        uint64_t result = rng_rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rng_rotl(s[3], 45);
+        return result;
+}
+
+//uniform in [0, bound), bound has to fit in 32 bits. Lemire's multiply and reject.
+static inline uint32_t rng_below(Rng * rng, uint32_t bound){
+        uint64_t product = (rng_next(rng) >> 32) * bound;
+        uint32_t low = (uint32_t)product;
+        if(low < bound){
+                uint32_t threshold = -bound % bound;
+                while(low < threshold){
+                        product = (rng_next(rng) >> 32) * bound;
+                        low = (uint32_t)product;
+                }
+        }
+        return product >> 32;
+}
+
+#endif
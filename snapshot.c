@@ -0,0 +1,275 @@
+#define _POSIX_C_SOURCE 200809L
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include "snapshot.h"
+#include "thread.h"
+#include "common.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static char const snapshot_magic[8] = {'s', 'w', 'e', 'e', 'p', 's', 'n', 'p'};
+#define SNAPSHOT_BYTE_ORDER 0x0102030405060708
+
+static uint64_t align_up(uint64_t offset){
+        return (offset + SNAPSHOT_ALIGN - 1) & ~(uint64_t)(SNAPSHOT_ALIGN - 1);
+}
+
+static Snapshot_Header make_header(Board const * board){
+        uint64_t tile_count = (uint64_t)board->grid_width * board->grid_height;
+        Snapshot_Header header = {
+                .version = SNAPSHOT_VERSION,
+                .tile_size = sizeof(Tile),
+                .byte_order = SNAPSHOT_BYTE_ORDER,
+                .seed = board->seed,
+                .grid_width = board->grid_width,
+                .grid_height = board->grid_height,
+                .total_mines = board->total_mines,
+                .planted = board->planted,
+                .first_click_safe = board->first_click_safe,
+                .hidden_safe_tiles = board->hidden_safe_tiles,
+                .unflagged_mines = board->unflagged_mines,
+                .flagged_mines = board->flagged_mines,
+                .wrong_flags = board->wrong_flags,
+                .failing = board->failing,
+                .exploding_mine_index = board->exploding_mine_index,
+                .clearing_row_index = board->clearing_row_index,
+                .filling = board->filling,
+                .fill_length = board->filling ? board->fill_tail - board->fill_head : 0,
+        };
+        memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+        memcpy(header.rng, board->rng.s, sizeof(header.rng));
+        header.tiles_offset = align_up(sizeof(Snapshot_Header));
+        header.mine_counts_offset = align_up(header.tiles_offset + tile_count * sizeof(Tile));
+        header.fill_offset = align_up(header.mine_counts_offset + tile_count);
+        return header;
+}
+
+static int seek_to(FILE * file, uint64_t offset){
+#if defined(_WIN32)
+        return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+        return fseeko(file, offset, SEEK_SET) == 0;
+#endif
+}
+
+static int write_at(FILE * file, uint64_t offset, void const * data, size_t size){
+        if(size == 0) return 1;
+        return seek_to(file, offset) && fwrite(data, 1, size, file) == size;
+}
+
+//rows [first_row, end_row) of both planes.
+static int write_rows(FILE * file, Board const * board, Snapshot_Header const * header, int first_row, int end_row){
+        uint64_t first = (uint64_t)first_row * board->grid_width;
+        uint64_t count = (uint64_t)(end_row - first_row) * board->grid_width;
+        return write_at(file, header->tiles_offset + first * sizeof(Tile), board->tiles + first, count * sizeof(Tile))
+                && write_at(file, header->mine_counts_offset + first, board->mine_counts + first, count);
+}
+
+//the fill queue then the header, last so a save that dies part way never has a header pointing at planes it didn't write.
+static int write_tail(FILE * file, Board const * board, Snapshot_Header const * header){
+        int const * queue = board->tiles_to_search + board->fill_head;
+        return write_at(file, header->fill_offset, queue, header->fill_length * sizeof(int))
+                && fflush(file) == 0
+                && write_at(file, 0, header, sizeof(Snapshot_Header));
+}
+
+int snapshot_save(Board const * board, char const * path){
+        size_t path_length = strlen(path);
+        char * new_path = malloc(path_length + sizeof(".new"));
+        if(!new_path) crash("out of memory for the snapshot path");
+        memcpy(new_path, path, path_length);
+        memcpy(new_path + path_length, ".new", sizeof(".new"));
+
+        FILE * file = fopen(new_path, "wb");
+        if(!file){
+                perror(new_path);
+                free(new_path);
+                return 0;
+        }
+        Snapshot_Header header = make_header(board);
+        int written = write_rows(file, board, &header, 0, board->grid_height) && write_tail(file, board, &header);
+        written &= fclose(file) == 0;
+#if defined(_WIN32)
+        //rename won't replace a file on windows.
+        if(written) remove(path);
+#endif
+        if(!written || rename(new_path, path) != 0){
+                perror(new_path);
+                remove(new_path);
+                free(new_path);
+                return 0;
+        }
+        free(new_path);
+        return 1;
+}
+
+int snapshot_save_changes(Board const * board, char const * path, uint64_t saved_changes){
+        FILE * file = fopen(path, "r+b");
+        if(!file) return snapshot_save(board, path);
+        Snapshot_Header header = make_header(board);
+        Snapshot_Header old;
+        int same_layout = fread(&old, sizeof(old), 1, file) == 1
+                && !memcmp(old.magic, header.magic, sizeof(header.magic))
+                && old.version == header.version
+                && old.tile_size == header.tile_size
+                && old.byte_order == header.byte_order
+                && old.grid_width == header.grid_width
+                && old.grid_height == header.grid_height;
+        if(!same_layout){
+                fclose(file);
+                return snapshot_save(board, path);
+        }
+
+        //runs of changed rows go out as one write each.
+        int written = 1;
+        for(int y = 0; y < board->grid_height && written;){
+                if(board->row_changes[y] <= saved_changes){
+                        ++y;
+                        continue;
+                }
+                int end_row = y + 1;
+                while(end_row < board->grid_height && board->row_changes[end_row] > saved_changes) ++end_row;
+                written = write_rows(file, board, &header, y, end_row);
+                y = end_row;
+        }
+        written = written && write_tail(file, board, &header);
+        written &= fclose(file) == 0;
+        if(!written) perror(path);
+        return written;
+}
+
+static int readable(Snapshot_Header const * header, uint64_t file_size){
+        if(memcmp(header->magic, snapshot_magic, sizeof(header->magic))
+                        || header->version != SNAPSHOT_VERSION
+                        || header->tile_size != sizeof(Tile)
+                        || header->byte_order != SNAPSHOT_BYTE_ORDER) return 0;
+        if(header->grid_width < 1 || header->grid_height < 1
+                        || (uint64_t)header->grid_width * header->grid_height > INT_MAX) return 0;
+        uint64_t tile_count = (uint64_t)header->grid_width * header->grid_height;
+        if(header->tiles_offset % SNAPSHOT_ALIGN || header->mine_counts_offset % SNAPSHOT_ALIGN || header->fill_offset % SNAPSHOT_ALIGN
+                        || header->tiles_offset < sizeof(Snapshot_Header)
+                        || header->tiles_offset + tile_count * sizeof(Tile) > header->mine_counts_offset
+                        || header->mine_counts_offset + tile_count > file_size) return 0;
+        if(header->fill_length < 0 || (uint64_t)header->fill_length > tile_count
+                        || (header->fill_length > 0 && header->fill_offset + header->fill_length * sizeof(int) > file_size)) return 0;
+        if(header->failing < not_exploding || header->failing > re_planting
+                        || header->exploding_mine_index < 0 || (uint64_t)header->exploding_mine_index > tile_count
+                        || header->clearing_row_index < 0 || header->clearing_row_index > header->grid_height) return 0;
+        return 1;
+}
+
+//the whole file in memory, mapped where there's mmap and read in everywhere else.
+static void * map_file(char const * path, size_t * size){
+#if defined(_WIN32)
+        FILE * file = fopen(path, "rb");
+        if(!file){
+                perror(path);
+                return NULL;
+        }
+        _fseeki64(file, 0, SEEK_END);
+        *size = _ftelli64(file);
+        void * mapping = malloc(*size ? *size : 1);
+        if(!mapping) crash("out of memory for the snapshot");
+        _fseeki64(file, 0, SEEK_SET);
+        int read = fread(mapping, 1, *size, file) == *size;
+        fclose(file);
+        if(!read){
+                perror(path);
+                free(mapping);
+                return NULL;
+        }
+        return mapping;
+#else
+        int file = open(path, O_RDONLY);
+        if(file < 0){
+                perror(path);
+                return NULL;
+        }
+        struct stat status;
+        if(fstat(file, &status) != 0 || status.st_size == 0){
+                fprintf(stderr, "%s is empty or unreadable\n", path);
+                close(file);
+                return NULL;
+        }
+        *size = status.st_size;
+        void * mapping = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+        close(file);
+        if(mapping == MAP_FAILED){
+                perror(path);
+                return NULL;
+        }
+        return mapping;
+#endif
+}
+
+void snapshot_unmap(void * mapping, size_t mapping_size){
+#if defined(_WIN32)
+        (void)mapping_size;
+        free(mapping);
+#else
+        munmap(mapping, mapping_size);
+#endif
+}
+
+int snapshot_load(Board * board, char const * path){
+        size_t size = 0;
+        char * mapping = map_file(path, &size);
+        if(!mapping) return 0;
+        Snapshot_Header const * header = (Snapshot_Header const *)mapping;
+        int ok = size >= sizeof(Snapshot_Header) && readable(header, size);
+        uint64_t tile_count = ok ? (uint64_t)header->grid_width * header->grid_height : 0;
+        int const * queue = ok ? (int const *)(mapping + header->fill_offset) : NULL;
+        //the queue indexes the planes, and a tile or count nothing can make means the planes were cut short or edited.
+        for(int i = 0; ok && i < header->fill_length; ++i) ok = queue[i] >= 0 && (uint64_t)queue[i] < tile_count;
+        Tile const * tiles = ok ? (Tile const *)(mapping + header->tiles_offset) : NULL;
+        uint8_t const * mine_counts = ok ? (uint8_t const *)(mapping + header->mine_counts_offset) : NULL;
+        int bad_tiles = 0;
+        for(uint64_t i = 0; ok && i < tile_count; ++i) bad_tiles |= (tiles[i] & ~(hidden | charged | flagged)) | (mine_counts[i] > 6);
+        ok = ok && !bad_tiles;
+        if(!ok){
+                fprintf(stderr, "%s isn't a snapshot this build can read\n", path);
+                snapshot_unmap(mapping, size);
+                return 0;
+        }
+
+        Board loaded = {
+                .grid_width = header->grid_width,
+                .grid_height = header->grid_height,
+                .total_mines = header->total_mines,
+                .seed = header->seed,
+                .planted = header->planted,
+                .first_click_safe = header->first_click_safe,
+                .plant_threads = hardware_threads(),
+                .tiles = (Tile *)(mapping + header->tiles_offset),
+                .mine_counts = (uint8_t *)(mapping + header->mine_counts_offset),
+                .mapping = mapping,
+                .mapping_size = size,
+                .failing = header->failing,
+                .exploding_mine_index = header->exploding_mine_index,
+                .clearing_row_index = header->clearing_row_index,
+                .filling = header->filling,
+                .fill_tail = header->fill_length,
+        };
+        memcpy(loaded.rng.s, header->rng, sizeof(loaded.rng.s));
+
+        //the win check runs off the counters, so they come from the tiles whatever the header says.
+        board_recount(&loaded);
+        if(loaded.hidden_safe_tiles != header->hidden_safe_tiles || loaded.unflagged_mines != header->unflagged_mines
+                        || loaded.flagged_mines != header->flagged_mines || loaded.wrong_flags != header->wrong_flags){
+                fprintf(stderr, "%s had counters that didn't match its tiles, recounted them\n", path);
+        }
+
+        //only the queue and the scratch get a block, the planes stay in the mapping.
+        board_lay_out(&loaded);
+        memcpy(loaded.tiles_to_search, queue, header->fill_length * sizeof(int));
+        board_touch_rows(&loaded, 0, loaded.grid_height);
+
+        *board = loaded;
+        return 1;
+}
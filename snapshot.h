@@ -0,0 +1,53 @@
+#ifndef SWEEP_SNAPSHOT_H
+#define SWEEP_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "board.h"
+
+//Board snapshots on disk. The tile and mine count planes are stored exactly as the Board holds them,
+//each starting on a page, so loading maps the file and points the board at it. loading still reads every page,
+//to check every tile and count is one a board could have made and to recount the counters from the tiles.
+
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_ALIGN 4096
+
+//the file starts with this, then the planes at their offsets:
+//tiles, width * height Tiles. mine counts, width * height bytes. the fill queue, fill_length ints.
+typedef struct{
+        char magic[8];
+        uint32_t version;
+        //a file written by a machine that lays Tiles or integers out differently won't load.
+        uint32_t tile_size;
+        uint64_t byte_order;
+
+        uint64_t seed;
+        uint64_t rng[4];
+        uint64_t tiles_offset;
+        uint64_t mine_counts_offset;
+        uint64_t fill_offset;
+
+        int32_t grid_width, grid_height;
+        int32_t total_mines;
+        int32_t planted, first_click_safe;
+        int32_t hidden_safe_tiles, unflagged_mines, flagged_mines, wrong_flags;
+        int32_t failing, exploding_mine_index, clearing_row_index;
+        //only the part of the fill queue that's still to be looked at is kept.
+        int32_t filling, fill_length;
+} Snapshot_Header;
+
+//writes the whole board to a new file and moves it over path, so a board mapped from path is left alone.
+//returns 0 and says why on stderr if it couldn't.
+int snapshot_save(Board const * board, char const * path);
+//writes only the rows that changed since saved_changes, plus the header and fill queue, into the snapshot at path.
+//path has to hold this board as it was at saved_changes. pass board->changes next time.
+int snapshot_save_changes(Board const * board, char const * path, uint64_t saved_changes);
+
+//maps the snapshot at path as the board's tiles and mine counts, copy on write so playing doesn't touch the file.
+//returns 0 and leaves the board alone if it isn't a snapshot this build can read, or a tile or count is one no board makes.
+//the counters come from the tiles, not the header. board_destroy unmaps it.
+int snapshot_load(Board * board, char const * path);
+
+void snapshot_unmap(void * mapping, size_t mapping_size);
+
+#endif
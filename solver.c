@@ -0,0 +1,493 @@
+#include <string.h>
+#include "solver.h"
+#include "profile.h"
+#include "common.h"
+
+//bits of listed besides the Solver_List ones, only set while one enumeration window is being built.
+#define IN_WINDOW (1 << 6)
+#define WINDOW_CONSTRAINT (1 << 7)
+
+size_t solver_memory(int grid_width, int grid_height){
+        size_t tile_count = (size_t)grid_width * grid_height;
+        return arena_bytes(sizeof(int) * tile_count) * (list_count + 1) + arena_bytes(tile_count) * 4;
+}
+
+void solver_create_in(Solver * solver, int grid_width, int grid_height, Arena * arena){
+        *solver = (Solver){0};
+        solver->grid_width = grid_width;
+        solver->grid_height = grid_height;
+        size_t tile_count = (size_t)grid_width * grid_height;
+        for(int list = 0; list < list_count; ++list) solver->lists[list] = arena_push(arena, sizeof(int) * tile_count);
+        solver->decided = arena_push(arena, sizeof(int) * tile_count);
+        solver->cells = arena_push(arena, tile_count);
+        solver->unknown_around = arena_push(arena, tile_count);
+        solver->mines_around = arena_push(arena, tile_count);
+        solver->listed = arena_push(arena, tile_count);
+}
+
+void solver_create(Solver * solver, int grid_width, int grid_height){
+        Arena arena;
+        arena_create(&arena, solver_memory(grid_width, grid_height));
+        solver_create_in(solver, grid_width, grid_height, &arena);
+        solver->arena = arena;
+}
+
+void solver_destroy(Solver * solver){
+        arena_destroy(&solver->arena);
+        *solver = (Solver){0};
+}
+
+static inline int tile_neighbors(Board const * board, int tile, int neighbors[6]){
+        return board_neighbors(board, tile % board->grid_width, tile / board->grid_width, neighbors);
+}
+
+//a tile is on each list at most once so the rings never overflow.
+static inline void push(Solver * solver, Solver_List list, int tile){
+        if(solver->listed[tile] & (1 << list)) return;
+        solver->listed[tile] |= 1 << list;
+        int capacity = solver->grid_width * solver->grid_height;
+        solver->lists[list][solver->tails[list]] = tile;
+        if(++solver->tails[list] == capacity) solver->tails[list] = 0;
+        ++solver->lengths[list];
+}
+
+static inline int pop(Solver * solver, Solver_List list, int * tile){
+        if(solver->lengths[list] == 0) return 0;
+        int capacity = solver->grid_width * solver->grid_height;
+        *tile = solver->lists[list][solver->heads[list]];
+        if(++solver->heads[list] == capacity) solver->heads[list] = 0;
+        --solver->lengths[list];
+        solver->listed[*tile] &= ~(1 << list);
+        return 1;
+}
+
+//the most recently pushed tile instead of the oldest.
+static inline int pop_newest(Solver * solver, Solver_List list, int * tile){
+        if(solver->lengths[list] == 0) return 0;
+        int capacity = solver->grid_width * solver->grid_height;
+        solver->tails[list] = (solver->tails[list] == 0 ? capacity : solver->tails[list]) - 1;
+        *tile = solver->lists[list][solver->tails[list]];
+        --solver->lengths[list];
+        solver->listed[*tile] &= ~(1 << list);
+        return 1;
+}
+
+//the tile's constraint changed, every rule has to look at it again.
+static inline void dirty(Solver * solver, int tile){
+        for(int list = 0; list < list_stuck; ++list) push(solver, list, tile);
+}
+
+static inline int remaining_mines(Solver const * solver, Board const * board, int tile){
+        return board->mine_counts[tile] - solver->mines_around[tile];
+}
+
+static void reveal(Solver * solver, Board const * board, int tile){
+        if(test_flags(board->tiles[tile], charged)) crash("the solver revealed a mine");
+        solver->cells[tile] = solver_safe;
+        solver->decided[solver->decided_count++] = tile;
+        --solver->safe_left;
+        int neighbors[6];
+        int count = tile_neighbors(board, tile, neighbors);
+        for(int i = 0; i < count; ++i){
+                int neighbor = neighbors[i];
+                --solver->unknown_around[neighbor];
+                if(solver->cells[neighbor] == solver_safe) dirty(solver, neighbor);
+        }
+        dirty(solver, tile);
+}
+
+static void mark_mine(Solver * solver, Board const * board, int tile){
+        solver->cells[tile] = solver_mine;
+        solver->decided[solver->decided_count++] = tile;
+        int neighbors[6];
+        int count = tile_neighbors(board, tile, neighbors);
+        for(int i = 0; i < count; ++i){
+                int neighbor = neighbors[i];
+                --solver->unknown_around[neighbor];
+                ++solver->mines_around[neighbor];
+                if(solver->cells[neighbor] == solver_safe) dirty(solver, neighbor);
+        }
+}
+
+//the unknown neighbors of tile, returns how many.
+static int unknown_neighbors(Solver const * solver, Board const * board, int tile, int unknown[6]){
+        int neighbors[6];
+        int count = tile_neighbors(board, tile, neighbors);
+        int unknown_count = 0;
+        for(int i = 0; i < count; ++i){
+                if(solver->cells[neighbors[i]] == solver_unknown) unknown[unknown_count++] = neighbors[i];
+        }
+        return unknown_count;
+}
+
+//decides tiles that are all safe or all mines, returns how many.
+static int decide(Solver * solver, Board const * board, int const * tiles, int count, int mines){
+        int decided = 0;
+        for(int i = 0; i < count; ++i){
+                if(solver->cells[tiles[i]] != solver_unknown) continue;
+                if(mines) mark_mine(solver, board, tiles[i]);
+                else reveal(solver, board, tiles[i]);
+                ++decided;
+        }
+        return decided;
+}
+
+//a number whose unknown neighbors are all safe or all mines. around a zero this is the same fill board_fill does.
+static void apply_single(Solver * solver, Board const * board, int tile){
+        if(solver->unknown_around[tile] == 0) return;
+        int unknown[6];
+        int count = unknown_neighbors(solver, board, tile, unknown);
+        int remaining = remaining_mines(solver, board, tile);
+        if(remaining == 0){
+                int decided = decide(solver, board, unknown, count, 0);
+                if(board->mine_counts[tile] == 0) solver->opened += decided;
+                else solver->single_deductions += decided;
+        }else if(remaining == count){
+                solver->single_deductions += decide(solver, board, unknown, count, 1);
+        }
+}
+
+//when small's unknown neighbors are all among big's, big's other unknown neighbors hold the difference in
+//remaining mines, which is sometimes none or all of them.
+static int apply_pair(Solver * solver, Board const * board, int small, int big){
+        int small_unknown[6], big_unknown[6];
+        int small_count = unknown_neighbors(solver, board, small, small_unknown);
+        int big_count = unknown_neighbors(solver, board, big, big_unknown);
+        if(small_count >= big_count) return 0;
+        int rest[6];
+        int rest_count = 0;
+        int shared = 0;
+        for(int i = 0; i < big_count; ++i){
+                int in_small = 0;
+                for(int j = 0; j < small_count; ++j) in_small |= big_unknown[i] == small_unknown[j];
+                if(in_small) ++shared;
+                else rest[rest_count++] = big_unknown[i];
+        }
+        if(shared != small_count) return 0;
+        int rest_mines = remaining_mines(solver, board, big) - remaining_mines(solver, board, small);
+        if(rest_mines != 0 && rest_mines != rest_count) return 0;
+        int decided = decide(solver, board, rest, rest_count, rest_mines != 0);
+        solver->subset_deductions += decided;
+        return decided;
+}
+
+//pairs tile up with every number that shares an unknown neighbor with it, both ways round.
+static void apply_subset(Solver * solver, Board const * board, int tile){
+        if(solver->unknown_around[tile] == 0) return;
+        int unknown[6];
+        int count = unknown_neighbors(solver, board, tile, unknown);
+        for(int i = 0; i < count; ++i){
+                int neighbors[6];
+                int neighbor_count = tile_neighbors(board, unknown[i], neighbors);
+                for(int j = 0; j < neighbor_count; ++j){
+                        int other = neighbors[j];
+                        if(other == tile || solver->cells[other] != solver_safe || solver->unknown_around[other] == 0) continue;
+                        if(apply_pair(solver, board, tile, other) || apply_pair(solver, board, other, tile)) return;
+                }
+        }
+}
+
+//one number next to the window, with running totals for the window cells assigned so far.
+typedef struct{
+        //its unknown neighbors outside the window, these can hold anywhere from 0 to all of them.
+        int outside;
+        int remaining;
+        int mines, open;
+} Window_Constraint;
+
+typedef struct{
+        int cells[SOLVER_WINDOW];
+        int cell_count;
+        Window_Constraint constraints[SOLVER_WINDOW * 6];
+        int constraint_count;
+        uint8_t cell_constraints[SOLVER_WINDOW][6];
+        int cell_constraint_counts[SOLVER_WINDOW];
+        uint32_t seen_mine, seen_safe;
+        int nodes;
+} Window;
+
+static inline int window_index(Window const * window, int tile){
+        for(int i = 0; i < window->cell_count; ++i) if(window->cells[i] == tile) return i;
+        return -1;
+}
+
+//depth first over every assignment of the window, keeping track of which cells were ever a mine and ever safe.
+//returns 0 once it runs out of nodes or every cell has been both, since nothing more can be learned.
+static int enumerate(Window * window, int cell, uint32_t assignment){
+        uint32_t all = (1u << window->cell_count) - 1;
+        if(cell == window->cell_count){
+                window->seen_mine |= assignment;
+                window->seen_safe |= ~assignment & all;
+                return window->seen_mine != all || window->seen_safe != all;
+        }
+        for(int mine = 0; mine <= 1; ++mine){
+                if(++window->nodes > SOLVER_ENUMERATION_NODES) return 0;
+                int possible = 1;
+                for(int i = 0; i < window->cell_constraint_counts[cell]; ++i){
+                        Window_Constraint * constraint = &window->constraints[window->cell_constraints[cell][i]];
+                        constraint->mines += mine;
+                        --constraint->open;
+                        possible &= constraint->mines <= constraint->remaining
+                                && constraint->mines + constraint->open + constraint->outside >= constraint->remaining;
+                }
+                int go_on = !possible || enumerate(window, cell + 1, assignment | (uint32_t)mine << cell);
+                for(int i = 0; i < window->cell_constraint_counts[cell]; ++i){
+                        Window_Constraint * constraint = &window->constraints[window->cell_constraints[cell][i]];
+                        constraint->mines -= mine;
+                        ++constraint->open;
+                }
+                if(!go_on) return 0;
+        }
+        return 1;
+}
+
+//grows a window of unknown tiles out from tile's unknown neighbors through the numbers next to them, tries every assignment
+//that fits the numbers and decides the cells that came out the same in all of them.
+static void apply_enumeration(Solver * solver, Board const * board, int tile){
+        if(solver->unknown_around[tile] == 0) return;
+        ++solver->windows;
+        Window window;
+        window.cell_count = unknown_neighbors(solver, board, tile, window.cells);
+        for(int i = 0; i < window.cell_count; ++i) solver->listed[window.cells[i]] |= IN_WINDOW;
+        for(int i = 0; i < window.cell_count && window.cell_count < SOLVER_WINDOW; ++i){
+                int neighbors[6];
+                int neighbor_count = tile_neighbors(board, window.cells[i], neighbors);
+                for(int j = 0; j < neighbor_count && window.cell_count < SOLVER_WINDOW; ++j){
+                        if(solver->cells[neighbors[j]] != solver_safe) continue;
+                        int unknown[6];
+                        int unknown_count = unknown_neighbors(solver, board, neighbors[j], unknown);
+                        for(int k = 0; k < unknown_count && window.cell_count < SOLVER_WINDOW; ++k){
+                                if(solver->listed[unknown[k]] & IN_WINDOW) continue;
+                                solver->listed[unknown[k]] |= IN_WINDOW;
+                                window.cells[window.cell_count++] = unknown[k];
+                        }
+                }
+        }
+
+        //every number next to the window constrains it.
+        window.constraint_count = 0;
+        int numbers[SOLVER_WINDOW * 6];
+        for(int i = 0; i < window.cell_count; ++i){
+                window.cell_constraint_counts[i] = 0;
+                int neighbors[6];
+                int neighbor_count = tile_neighbors(board, window.cells[i], neighbors);
+                for(int j = 0; j < neighbor_count; ++j){
+                        int number = neighbors[j];
+                        if(solver->cells[number] != solver_safe || solver->listed[number] & WINDOW_CONSTRAINT) continue;
+                        solver->listed[number] |= WINDOW_CONSTRAINT;
+                        numbers[window.constraint_count++] = number;
+                }
+        }
+        for(int c = 0; c < window.constraint_count; ++c){
+                int number = numbers[c];
+                solver->listed[number] &= ~WINDOW_CONSTRAINT;
+                Window_Constraint constraint = {.remaining = remaining_mines(solver, board, number)};
+                int unknown[6];
+                int unknown_count = unknown_neighbors(solver, board, number, unknown);
+                for(int k = 0; k < unknown_count; ++k){
+                        int cell = window_index(&window, unknown[k]);
+                        if(cell < 0){
+                                ++constraint.outside;
+                                continue;
+                        }
+                        ++constraint.open;
+                        window.cell_constraints[cell][window.cell_constraint_counts[cell]++] = c;
+                }
+                window.constraints[c] = constraint;
+        }
+        for(int i = 0; i < window.cell_count; ++i) solver->listed[window.cells[i]] &= ~IN_WINDOW;
+
+        window.seen_mine = window.seen_safe = 0;
+        window.nodes = 0;
+        if(!enumerate(&window, 0, 0) && window.nodes > SOLVER_ENUMERATION_NODES){
+                push(solver, list_stuck, tile);
+                return;
+        }
+        //no assignment at all means the numbers contradict each other, which the true board never does.
+        if(!(window.seen_mine | window.seen_safe)) crash("the solver's numbers contradict each other");
+        int decided = 0;
+        for(int i = 0; i < window.cell_count; ++i){
+                uint32_t bit = 1u << i;
+                if(!(window.seen_mine & bit)){
+                        reveal(solver, board, window.cells[i]);
+                        ++decided;
+                }else if(!(window.seen_safe & bit)){
+                        mark_mine(solver, board, window.cells[i]);
+                        ++decided;
+                }
+        }
+        solver->enumeration_deductions += decided;
+        if(!decided) push(solver, list_stuck, tile);
+}
+
+static inline int swappable(Solver const * solver, Board const * board, int tile, int const * avoid, int avoid_count, int want_mine){
+        if(solver->cells[tile] != solver_unknown || test_flags(board->tiles[tile], charged) != want_mine) return 0;
+        for(int i = 0; i < avoid_count; ++i) if(avoid[i] == tile) return 0;
+        return 1;
+}
+
+//an unknown tile outside avoid that is or isn't a mine, preferring ones away from any number since moving a
+//mine to or from there changes no number the solver has seen. when random tiles keep turning out revealed, as
+//they do late in a solve, it looks around near, the unknown side of the frontier.
+static int find_swap(Solver const * solver, Board const * board, Rng * rng, int near, int const * avoid, int avoid_count, int want_mine){
+        int tile_count = board->grid_width * board->grid_height;
+        int near_x = near % board->grid_width;
+        int near_y = near / board->grid_width;
+        for(int attempt = 0; attempt < 128; ++attempt){
+                int tile;
+                if(attempt >= 32 && attempt < 96){
+                        int x = near_x + (int)rng_below(rng, 33) - 16;
+                        int y = near_y + (int)rng_below(rng, 33) - 16;
+                        if(x < 0 || x >= board->grid_width || y < 0 || y >= board->grid_height) continue;
+                        tile = board_tile_index(board, x, y);
+                }else{
+                        tile = rng_below(rng, tile_count);
+                }
+                if(!swappable(solver, board, tile, avoid, avoid_count, want_mine)) continue;
+                int neighbors[6];
+                int count = tile_neighbors(board, tile, neighbors);
+                int far = 1;
+                for(int i = 0; i < count; ++i) far &= solver->cells[neighbors[i]] != solver_safe;
+                if(far || attempt >= 96) return tile;
+        }
+        for(int i = 0; i < tile_count; ++i){
+                int tile = (near + i) % tile_count;
+                if(swappable(solver, board, tile, avoid, avoid_count, want_mine)) return tile;
+        }
+        return -1;
+}
+
+static void move_mine(Solver * solver, Board * board, int from, int to){
+        board_set_mine(board, from, 0);
+        board_set_mine(board, to, 1);
+        int ends[2] = {from, to};
+        for(int end = 0; end < 2; ++end){
+                int neighbors[6];
+                int count = tile_neighbors(board, ends[end], neighbors);
+                for(int i = 0; i < count; ++i) if(solver->cells[neighbors[i]] == solver_safe) dirty(solver, neighbors[i]);
+        }
+}
+
+//forgets a mine the solver had worked out, for moving it.
+static void unmark_mine(Solver * solver, Board const * board, int tile){
+        solver->cells[tile] = solver_unknown;
+        int neighbors[6];
+        int count = tile_neighbors(board, tile, neighbors);
+        for(int i = 0; i < count; ++i){
+                int neighbor = neighbors[i];
+                ++solver->unknown_around[neighbor];
+                --solver->mines_around[neighbor];
+                if(solver->cells[neighbor] == solver_safe) dirty(solver, neighbor);
+        }
+}
+
+//every number is finished but safe tiles are left, walled in by mines where no number can ever reach them.
+//one becomes a mine and a random mine the solver already found elsewhere becomes safe instead. the numbers
+//next to that one have no mines left so they open it, and it's far enough away that fixing up what that
+//changed doesn't undo this.
+static int open_wall(Solver * solver, Board * board, Rng * rng){
+        int tile_count = board->grid_width * board->grid_height;
+        int walled = -1;
+        for(int i = 0; i < tile_count && walled < 0; ++i){
+                int tile = solver->wall_cursor + i < tile_count ? solver->wall_cursor + i : solver->wall_cursor + i - tile_count;
+                if(solver->cells[tile] == solver_unknown && !test_flags(board->tiles[tile], charged)) walled = tile;
+        }
+        if(walled < 0) return 0;
+        solver->wall_cursor = walled;
+        int found = -1;
+        for(int attempt = 0; attempt < 256 && found < 0; ++attempt){
+                int tile = rng_below(rng, tile_count);
+                if(solver->cells[tile] == solver_mine) found = tile;
+        }
+        int start = rng_below(rng, tile_count);
+        for(int i = 0; i < tile_count && found < 0; ++i){
+                int tile = (start + i) % tile_count;
+                if(solver->cells[tile] == solver_mine) found = tile;
+        }
+        if(found < 0) return 0;
+        unmark_mine(solver, board, found);
+        move_mine(solver, board, found, walled);
+        ++solver->perturbations;
+        return 1;
+}
+
+//the solver is stuck, so a number it couldn't finish gets every unknown neighbor cleared by moving
+//their mines to unknown tiles elsewhere, or failing that filled with mines from elsewhere. what the solver knows stays true, only numbers next to the moved mines change.
+static int perturb(Solver * solver, Board * board, Rng * rng){
+        //every number with unknown neighbors left went through enumeration and ended up here.
+        int tile;
+        do{
+                if(!pop_newest(solver, list_stuck, &tile)) return open_wall(solver, board, rng);
+        }while(solver->unknown_around[tile] == 0);
+        int unknown[6];
+        int count = unknown_neighbors(solver, board, tile, unknown);
+        int cleared = 1;
+        for(int i = 0; i < count && cleared; ++i){
+                if(!test_flags(board->tiles[unknown[i]], charged)) continue;
+                int to = find_swap(solver, board, rng, tile, unknown, count, 0);
+                if(to < 0) cleared = 0;
+                else move_mine(solver, board, unknown[i], to);
+        }
+        //near the end there may be no safe tile left to take the mines, so fill the neighbors instead.
+        for(int i = 0; i < count && !cleared; ++i){
+                if(test_flags(board->tiles[unknown[i]], charged)) continue;
+                int from = find_swap(solver, board, rng, tile, unknown, count, 1);
+                if(from < 0) return 0;
+                move_mine(solver, board, from, unknown[i]);
+        }
+        ++solver->perturbations;
+        dirty(solver, tile);
+        return 1;
+}
+
+void solver_reset(Solver * solver, Board const * board){
+        if(board->grid_width != solver->grid_width || board->grid_height != solver->grid_height) crash("the solver is sized for another board");
+        int tile_count = board->grid_width * board->grid_height;
+        solver->safe_left = 0;
+        for(int tile = 0; tile < tile_count; ++tile){
+                int neighbors[6];
+                solver->unknown_around[tile] = tile_neighbors(board, tile, neighbors);
+                solver->safe_left += !test_flags(board->tiles[tile], charged);
+        }
+        memset(solver->cells, solver_unknown, tile_count);
+        memset(solver->mines_around, 0, tile_count);
+        memset(solver->listed, 0, tile_count);
+        for(int list = 0; list < list_count; ++list) solver->heads[list] = solver->tails[list] = solver->lengths[list] = 0;
+        solver->decided_count = 0;
+        solver->wall_cursor = 0;
+        solver->opened = solver->single_deductions = solver->subset_deductions = solver->enumeration_deductions = 0;
+        solver->windows = solver->perturbations = 0;
+}
+
+void solver_learn(Solver * solver, Board const * board, int tile){
+        if(solver->cells[tile] == solver_unknown) reveal(solver, board, tile);
+}
+
+int solver_think(Solver * solver, Board const * board){
+        uint64_t steps = 0;
+        int tile;
+        while(solver->safe_left > 0){
+                if(solver->deadline > 0 && (++steps & 1023) == 0 && profile_now() > solver->deadline) return 0;
+                //cheapest rule first, anything a rule decides dirties its neighbors for the single rule again.
+                if(pop(solver, list_single, &tile)) apply_single(solver, board, tile);
+                else if(pop(solver, list_subset, &tile)) apply_subset(solver, board, tile);
+                else if(pop(solver, list_enumerate, &tile)) apply_enumeration(solver, board, tile);
+                else break;
+        }
+        return 1;
+}
+
+int solver_solve(Solver * solver, Board * board, int x, int y, Rng * perturb_rng){
+        int start = board_tile_index(board, x, y);
+        if(test_flags(board->tiles[start], charged)) return 0;
+        solver_reset(solver, board);
+        reveal(solver, board, start);
+        ++solver->opened;
+        for(;;){
+                if(!solver_think(solver, board)) return 0;
+                if(solver->safe_left == 0) return 1;
+                if(!perturb_rng || !perturb(solver, board, perturb_rng)) return 0;
+                //decided has room for each tile once and a repair can undecide one, nothing reads it while repairing.
+                solver->decided_count = 0;
+        }
+}
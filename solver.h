@@ -0,0 +1,89 @@
+#ifndef SWEEP_SOLVER_H
+#define SWEEP_SOLVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "arena.h"
+#include "board.h"
+#include "rng.h"
+
+//Plays a board from a first click using only what a player could see, to tell whether it can be
+//finished without guessing. Each revealed number says how many of its unknown neighbors are mines.
+//The solver tries, cheapest first: a number on its own, a pair of numbers where one's unknown neighbors
+//are a subset of the other's, then every assignment of a small window of the frontier.
+
+//the most frontier tiles one enumeration window looks at, and how many assignments it may try.
+#define SOLVER_WINDOW 16
+#define SOLVER_ENUMERATION_NODES (1 << 14)
+
+typedef enum{
+        solver_unknown,
+        solver_safe,
+        solver_mine,
+} Solver_Cell;
+
+typedef enum{
+        list_single,
+        list_subset,
+        list_enumerate,
+        //numbers every rule gave up on, where a stuck generator repairs the board.
+        list_stuck,
+        list_count
+} Solver_List;
+
+typedef struct{
+        int grid_width, grid_height;
+        //Solver_Cell per tile, safe tiles are the revealed ones.
+        uint8_t * cells;
+        //every tile revealed or found to be a mine, in order.
+        int * decided;
+        int decided_count;
+        //a revealed tile's unknown neighbors hold mine_count - mines_around mines.
+        uint8_t * unknown_around;
+        uint8_t * mines_around;
+        //bit per Solver_List the tile is on.
+        uint8_t * listed;
+        //revealed tiles whose neighborhood changed since each rule last looked at them, rings of tile_count.
+        int * lists[list_count];
+        int heads[list_count], tails[list_count], lengths[list_count];
+        //where the search for safe tiles walled in by mines picks up, see open_wall.
+        int wall_cursor;
+        int safe_left;
+        //profile_now time to give up at, 0 for never.
+        double deadline;
+        //owns the arrays unless they came from someone else's arena.
+        Arena arena;
+
+        //what the last solve did, tiles the zero fill opened and tiles each rule decided.
+        uint64_t opened;
+        uint64_t single_deductions;
+        uint64_t subset_deductions;
+        uint64_t enumeration_deductions;
+        uint64_t windows;
+        uint64_t perturbations;
+} Solver;
+
+void solver_create(Solver * solver, int grid_width, int grid_height);
+//takes solver_memory bytes from arena instead, solver_destroy then leaves them to the arena.
+void solver_create_in(Solver * solver, int grid_width, int grid_height, Arena * arena);
+size_t solver_memory(int grid_width, int grid_height);
+void solver_destroy(Solver * solver);
+
+//returns 1 if every safe tile gets revealed without a guess. x, y has to be safe.
+//with perturb set a stuck solver moves mines so the board can go on instead of giving up. the board it
+//leaves then differs from the one it was given, and has to be solved again from scratch to be sure of it.
+int solver_solve(Solver * solver, Board * board, int x, int y, Rng * perturb);
+
+//playing alongside a board instead: reset, learn every tile the board shows revealed, think, then reveal and flag
+//what it decided. when thinking decides nothing a player has to guess, and learns the result if they survive.
+void solver_reset(Solver * solver, Board const * board);
+void solver_learn(Solver * solver, Board const * board, int tile);
+//applies the rules until none has anything left to look at, returns 0 if it ran past the deadline.
+int solver_think(Solver * solver, Board const * board);
+
+//tiles decided by reasoning about numbers, rather than opened around zeros.
+static inline uint64_t solver_frontier_cells(Solver const * solver){
+        return solver->single_deductions + solver->subset_deductions + solver->enumeration_deductions;
+}
+
+#endif
@@ -0,0 +1,169 @@
+#define _POSIX_C_SOURCE 200809L
+#include "thread.h"
+#include "common.h"
+
+#if defined(SWEEP_NO_THREADS) || defined(_WIN32) || (defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__))
+#define SWEEP_SERIAL 1
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define MAX_THREADS 256
+
+int hardware_threads(void){
+#if defined(SWEEP_SERIAL)
+        return 1;
+#else
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        if(count < 1) return 1;
+        return count > MAX_THREADS ? MAX_THREADS : count;
+#endif
+}
+
+#if !defined(SWEEP_SERIAL)
+typedef struct{
+        Parallel_Job job;
+        void * data;
+        int first, stride, count;
+} Worker;
+
+static void * run_worker(void * worker_p){
+        Worker * worker = worker_p;
+        for(int i = worker->first; i < worker->count; i += worker->stride) worker->job(worker->data, i);
+        return NULL;
+}
+#endif
+
+#if !defined(SWEEP_SERIAL)
+//what's left of one thread's share, padded to its own cache line so threads taking from their own don't contend.
+typedef struct{
+        pthread_mutex_t lock;
+        int64_t next, end;
+        char padding[64];
+} Steal_Range;
+
+typedef struct{
+        Stealing_Job job;
+        void * data;
+        int batch;
+        int thread_count;
+        Steal_Range * ranges;
+} Steal_Pool;
+
+typedef struct{
+        Steal_Pool * pool;
+        int thread;
+} Steal_Worker;
+
+static int take(Steal_Range * range, int batch, int64_t * first, int64_t * end){
+        pthread_mutex_lock(&range->lock);
+        int taken = range->next < range->end;
+        *first = range->next;
+        range->next = range->next + batch < range->end ? range->next + batch : range->end;
+        *end = range->next;
+        pthread_mutex_unlock(&range->lock);
+        return taken;
+}
+
+//moves the back half of the biggest share left into the thief's, returns 0 once every share is empty.
+static int steal(Steal_Pool * pool, int thief){
+        for(;;){
+                int victim = -1;
+                int64_t most = 0;
+                for(int i = 0; i < pool->thread_count; ++i){
+                        if(i == thief) continue;
+                        pthread_mutex_lock(&pool->ranges[i].lock);
+                        int64_t left = pool->ranges[i].end - pool->ranges[i].next;
+                        pthread_mutex_unlock(&pool->ranges[i].lock);
+                        if(left > most){
+                                most = left;
+                                victim = i;
+                        }
+                }
+                if(victim < 0) return 0;
+
+                Steal_Range * range = &pool->ranges[victim];
+                pthread_mutex_lock(&range->lock);
+                int64_t left = range->end - range->next;
+                int64_t stolen = left - left / 2;
+                int64_t end = range->end;
+                range->end -= stolen;
+                pthread_mutex_unlock(&range->lock);
+                //someone else got there first, look again.
+                if(stolen <= 0) continue;
+
+                Steal_Range * own = &pool->ranges[thief];
+                pthread_mutex_lock(&own->lock);
+                own->next = end - stolen;
+                own->end = end;
+                pthread_mutex_unlock(&own->lock);
+                return 1;
+        }
+}
+
+static void * run_stealing_worker(void * worker_p){
+        Steal_Worker * worker = worker_p;
+        Steal_Pool * pool = worker->pool;
+        Steal_Range * own = &pool->ranges[worker->thread];
+        int64_t first, end;
+        do{
+                while(take(own, pool->batch, &first, &end)){
+                        for(int64_t i = first; i < end; ++i) pool->job(pool->data, worker->thread, i);
+                }
+        }while(steal(pool, worker->thread));
+        return NULL;
+}
+#endif
+
+void parallel_for_stealing(int64_t count, int thread_count, int batch, Stealing_Job job, void * data){
+        if(thread_count > count) thread_count = count;
+        if(thread_count > MAX_THREADS) thread_count = MAX_THREADS;
+        if(batch < 1) batch = 1;
+#if !defined(SWEEP_SERIAL)
+        if(thread_count > 1){
+                Steal_Range * ranges = malloc(sizeof(Steal_Range) * thread_count);
+                if(!ranges) crash("out of memory for the thread pool");
+                Steal_Pool pool = {.job = job, .data = data, .batch = batch, .thread_count = thread_count, .ranges = ranges};
+                Steal_Worker workers[MAX_THREADS];
+                pthread_t threads[MAX_THREADS];
+                for(int i = 0; i < thread_count; ++i){
+                        pthread_mutex_init(&ranges[i].lock, NULL);
+                        ranges[i].next = count * i / thread_count;
+                        ranges[i].end = count * (i + 1) / thread_count;
+                        workers[i] = (Steal_Worker){.pool = &pool, .thread = i};
+                }
+                for(int i = 1; i < thread_count; ++i){
+                        if(pthread_create(&threads[i], NULL, run_stealing_worker, &workers[i])) crash("failed to create a thread");
+                }
+                run_stealing_worker(&workers[0]);
+                for(int i = 1; i < thread_count; ++i) pthread_join(threads[i], NULL);
+                for(int i = 0; i < thread_count; ++i) pthread_mutex_destroy(&ranges[i].lock);
+                free(ranges);
+                return;
+        }
+#endif
+        for(int64_t i = 0; i < count; ++i) job(data, 0, i);
+}
+
+void parallel_for(int count, int thread_count, Parallel_Job job, void * data){
+        if(thread_count > count) thread_count = count;
+        if(thread_count > MAX_THREADS) thread_count = MAX_THREADS;
+#if !defined(SWEEP_SERIAL)
+        if(thread_count > 1){
+                Worker workers[MAX_THREADS];
+                pthread_t threads[MAX_THREADS];
+                for(int i = 0; i < thread_count; ++i){
+                        workers[i] = (Worker){.job = job, .data = data, .first = i, .stride = thread_count, .count = count};
+                }
+                //the calling thread takes the first share.
+                for(int i = 1; i < thread_count; ++i){
+                        if(pthread_create(&threads[i], NULL, run_worker, &workers[i])) crash("failed to create a thread");
+                }
+                run_worker(&workers[0]);
+                for(int i = 1; i < thread_count; ++i) pthread_join(threads[i], NULL);
+                return;
+        }
+#endif
+        for(int i = 0; i < count; ++i) job(data, i);
+}
@@ -0,0 +1,25 @@
+#ifndef SWEEP_THREAD_H
+#define SWEEP_THREAD_H
+
+#include <stdint.h>
+
+//Splits work across cores, runs everything on the calling thread when there are no threads
+//(SWEEP_NO_THREADS, windows, or emscripten without -pthread).
+
+typedef void (*Parallel_Job)(void * data, int index);
+
+int hardware_threads(void);
+
+//calls job(data, i) for every i in [0, count) on up to thread_count threads and waits for all of them.
+//which thread runs an index is not defined, so jobs must only write to what their index owns.
+void parallel_for(int count, int thread_count, Parallel_Job job, void * data);
+
+typedef void (*Stealing_Job)(void * data, int thread, int64_t index);
+
+//calls job(data, thread, i) for every i in [0, count) on up to thread_count threads and waits for all of them.
+//each thread starts on an even share of the range and takes batch indices at a time from the front of it,
+//a thread that runs out steals the back half of the biggest share left, so uneven jobs keep every thread busy.
+//thread is in [0, thread_count) and runs one job at a time, so jobs can keep per thread state in a slot per thread.
+void parallel_for_stealing(int64_t count, int thread_count, int batch, Stealing_Job job, void * data);
+
+#endif